@@ -0,0 +1,178 @@
+/**
+ * \brief analytic estimate of the throughput of the alternating bit link.
+ *
+ * The Sender prepares a packet for PREPARATION_TIME (P) and sends it. If no
+ * acknowledgement arrives within timeout (T) it prepares the packet again,
+ * so copy k of a packet leaves at k * (T + P) after the first one. Every
+ * copy crosses the data subnet (delay D1, loss L), waits for the Receiver
+ * (R) and crosses the ack subnet (delay D2, loss L); the first
+ * acknowledgement that comes back, whatever the copy it belongs to, ends
+ * the packet. With q = (1 - L)^2 and F the distribution of D1 + R + D2, the
+ * time A from the first copy to the acknowledgement has
+ *
+ *   P(A > a) = prod over k with k(T+P) <= a of (1 - q F(a - k(T+P)))
+ *
+ * and a packet takes P + E[A] on average. The product is periodic in
+ * T + P once a copy can no longer be late, so E[A] and the expected number
+ * of copies are integrals over one period plus a geometric tail.
+ *
+ * F comes from samples of the delay model of the subnets, so every delay
+ * model of channel_model.hpp can be used. A Gilbert-Elliott loss is taken
+ * at its stationary loss probability, which ignores the correlation of the
+ * losses of successive copies. Two effects of the Receiver are ignored as
+ * well: a copy that arrives while the previous acknowledgement is being
+ * prepared restarts the preparation, and an old acknowledgement can carry
+ * the bit of the current packet. Both need a copy late by about T + P, so
+ * they are rare with the default settings; the validation mode of
+ * estimate_pg measures how far the estimate is from the simulation.
+ */
+
+#ifndef _ABP_ESTIMATOR_HPP_
+#define _ABP_ESTIMATOR_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "channel_model.hpp"
+
+/**<points of the integral over one period*/
+static constexpr int ESTIMATOR_PERIOD_STEPS = 4000;
+
+/**
+ * Parameters of the alternating bit link, times in seconds.
+ */
+
+struct abp_estimate_params{
+    double sender_preparation = 10;     /**<PREPARATION_TIME of Sender*/
+    double timeout = 20;                /**<timeout of Sender*/
+    double receiver_preparation = 10;   /**<PREPARATION_TIME of Receiver*/
+    channel_config channel;             /**<delay and loss of both subnets*/
+    long packets = 1;                   /**<packets of the transfer*/
+    double start = 0;                   /**<time of the control message*/
+    int samples = 100000;               /**<samples of the round trip time*/
+    unsigned int seed = 1;              /**<seed of the samples*/
+};
+
+/**
+ * Expected measures of one transfer.
+ */
+
+struct abp_estimate{
+    double loss = 0;             /**<loss probability of one subnet*/
+    double success = 0;          /**<probability that a copy is acknowledged*/
+    double mean_rtt = 0;         /**<mean of D1 + R + D2*/
+    double mean_wait = 0;        /**<E[A], first copy to acknowledgement*/
+    double copies = 0;           /**<copies sent per packet*/
+    double cycle = 0;            /**<time per packet, P + E[A]*/
+    double retransmissions = 0;  /**<copies sent again for the transfer*/
+    double completion_time = 0;  /**<time of the last acknowledgement*/
+    double throughput = 0;       /**<packets / completion_time, as replicate_pg*/
+};
+
+/**
+ * Long run loss probability of a loss model.
+ * @param spec description of the loss model, see channel_model.hpp
+ * @return the probability that a packet is lost
+ */
+
+inline double stationary_loss(const std::string &spec){
+    std::vector<std::string> fields = split_channel_spec(spec);
+    const std::string name = fields.empty() ? std::string() : fields[0];
+    if(name == "bernoulli"){
+        return channel_probability(fields, 1, spec);
+    }else if(name == "gilbert"){
+        const double good_to_bad = channel_probability(fields, 1, spec);
+        const double bad_to_good = channel_probability(fields, 2, spec);
+        const double loss_good = channel_probability(fields, 3, spec);
+        const double loss_bad = channel_probability(fields, 4, spec);
+        if(good_to_bad + bad_to_good <= 0){
+            return loss_good;
+        }
+        const double bad = good_to_bad / (good_to_bad + bad_to_good);
+        return (1 - bad) * loss_good + bad * loss_bad;
+    }
+    throw std::invalid_argument("unknown loss model " + spec);
+}
+
+/**
+ * Computes the expected throughput and completion time of a transfer.
+ * @param params the link and the transfer
+ * @return the estimate, with a throughput of 0 when no copy can get through
+ */
+
+inline abp_estimate estimate_abp(const abp_estimate_params &params){
+    abp_estimate estimate;
+    estimate.loss = stationary_loss(params.channel.loss);
+    estimate.success = (1 - estimate.loss) * (1 - estimate.loss);
+    const double q = estimate.success;
+    const double period = params.timeout + params.sender_preparation;
+
+    // sorted samples of the round trip time give F
+    channel_model channel(params.channel, params.seed);
+    std::vector<double> rtt(params.samples > 0 ? params.samples : 1);
+    double sum = 0;
+    for(double &sample : rtt){
+        sample = channel.next_delay() + params.receiver_preparation +
+            channel.next_delay();
+        sum += sample;
+    }
+    std::sort(rtt.begin(), rtt.end());
+    estimate.mean_rtt = sum / rtt.size();
+    auto cdf = [&rtt](double x){
+        return static_cast<double>(std::upper_bound(rtt.begin(), rtt.end(), x) -
+            rtt.begin()) / rtt.size();
+    };
+
+    if(q <= 0 || period <= 0){
+        estimate.mean_wait = std::numeric_limits<double>::infinity();
+        estimate.copies = std::numeric_limits<double>::infinity();
+        estimate.cycle = std::numeric_limits<double>::infinity();
+        estimate.retransmissions = std::numeric_limits<double>::infinity();
+        estimate.completion_time = std::numeric_limits<double>::infinity();
+        return estimate;
+    }
+
+    // copies k >= late can no longer be late at any point of a period
+    const int late = static_cast<int>(std::ceil(rtt.back() / period)) + 1;
+
+    // E[A]: for a = k * period + u, P(A > a) is the product of the factors
+    // of the copies 0..k, those older than late are all (1 - q)
+    double wait = 0;
+    const double step = period / ESTIMATOR_PERIOD_STEPS;
+    for(int i = 0; i < ESTIMATOR_PERIOD_STEPS; i++){
+        const double u = (i + 0.5) * step;
+        double survival = 1;
+        double sum_periods = 0;
+        for(int k = 0; k < late; k++){
+            survival *= 1 - q * cdf(u + k * period);
+            sum_periods += survival;
+        }
+        sum_periods += survival * (1 - q) / q;
+        wait += sum_periods * step;
+    }
+    estimate.mean_wait = wait;
+
+    // copy k is sent when A > k * period
+    double copies = 1;
+    double survival = 1;
+    for(int k = 1; k <= late; k++){
+        survival *= 1 - q * cdf(k * period);
+        copies += survival;
+    }
+    copies += survival * (1 - q) / q;
+    estimate.copies = copies;
+
+    estimate.cycle = params.sender_preparation + estimate.mean_wait;
+    estimate.retransmissions = params.packets * (estimate.copies - 1);
+    estimate.completion_time = params.start + params.packets * estimate.cycle;
+    if(estimate.completion_time > 0){
+        estimate.throughput = params.packets / estimate.completion_time;
+    }
+    return estimate;
+}
+
+#endif // _ABP_ESTIMATOR_HPP_
@@ -0,0 +1,145 @@
+/**
+ * \brief Static (compile time coupled) version of the ABP top model.
+ *
+ * The hierarchy is the one built by make_abp_top with one link:
+ *
+ *   TOP: generator_con, ABPSimulator1
+ *   ABPSimulator1: sender1, receiver1, Network1
+ *   Network1: subnet1, subnet2
+ *
+ * but the models, ports and couplings are types, so the static runner of
+ * cadmium routes messages through tuples instead of typeid lookups and
+ * virtual calls. The number of links is fixed by the types, so there is only
+ * one link.
+ *
+ * Static atomic models are built with their default constructor, so the
+ * control file, the seed and the channel of the run are read from
+ * abp_static_config(), which has to be filled before the runner is built.
+ */
+
+#ifndef _ABP_STATIC_HPP_
+#define _ABP_STATIC_HPP_
+
+#include <string>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+
+#include "abp_topology.hpp"
+
+/**
+ * Settings of the static top model.
+ */
+
+struct abp_static_settings{
+    std::string input;          /**<control file of generator_con*/
+    unsigned int seed = 0;      /**<seed of the run*/
+    channel_config channel;     /**<delay and loss models of the subnets*/
+};
+
+/**
+ * @return settings read by the static models when they are built
+ */
+
+inline abp_static_settings& abp_static_config(){
+    static abp_static_settings settings;
+    return settings;
+}
+
+/********************************************/
+/****** ATOMIC MODELS *******************/
+/********************************************/
+template<typename TIME>
+class generator_con : public ApplicationGen<TIME> {
+    public:
+    generator_con() : ApplicationGen<TIME>(abp_static_config().input.c_str()) {}
+};
+
+template<typename TIME>
+class sender1 : public Sender<TIME> {};
+
+template<typename TIME>
+class receiver1 : public Receiver<TIME> {};
+
+template<typename TIME>
+class subnet1 : public Subnet<TIME> {
+    public:
+    subnet1() : Subnet<TIME>(abp_static_config().channel,
+        subnet_seed(abp_static_config().seed, 1)) {}
+};
+
+template<typename TIME>
+class subnet2 : public Subnet<TIME> {
+    public:
+    subnet2() : Subnet<TIME>(abp_static_config().channel,
+        subnet_seed(abp_static_config().seed, 2)) {}
+};
+
+/************************/
+/*******NETWORK********/
+/************************/
+using iports_Network = std::tuple<input_1,input_2>;
+using oports_Network = std::tuple<output_1,output_2>;
+using submodels_Network = cadmium::modeling::models_tuple<subnet1,subnet2>;
+using eics_Network = std::tuple<
+    cadmium::modeling::EIC<input_1, subnet1, subnet_defs::input>,
+    cadmium::modeling::EIC<input_2, subnet2, subnet_defs::input>
+>;
+using eocs_Network = std::tuple<
+    cadmium::modeling::EOC<subnet1, subnet_defs::output, output_1>,
+    cadmium::modeling::EOC<subnet2, subnet_defs::output, output_2>
+>;
+using ics_Network = std::tuple<>;
+
+template<typename TIME>
+using Network1 = cadmium::modeling::coupled_model<TIME, iports_Network,
+    oports_Network, submodels_Network, eics_Network, eocs_Network, ics_Network>;
+
+/************************/
+/*******ABPSimulator********/
+/************************/
+using iports_ABPSimulator = std::tuple<input_control>;
+using oports_ABPSimulator = std::tuple<output_acknowledge,output_pack>;
+using submodels_ABPSimulator =
+    cadmium::modeling::models_tuple<sender1,receiver1,Network1>;
+using eics_ABPSimulator = std::tuple<
+    cadmium::modeling::EIC<input_control, sender1, sender_defs::control_in>
+>;
+using eocs_ABPSimulator = std::tuple<
+    cadmium::modeling::EOC<sender1, sender_defs::packet_sent_out, output_pack>,
+    cadmium::modeling::EOC<sender1, sender_defs::ack_received_out, output_acknowledge>
+>;
+using ics_ABPSimulator = std::tuple<
+    cadmium::modeling::IC<sender1, sender_defs::data_out, Network1, input_1>,
+    cadmium::modeling::IC<Network1, output_2, sender1, sender_defs::ack_in>,
+    cadmium::modeling::IC<receiver1, receiver_defs::output, Network1, input_2>,
+    cadmium::modeling::IC<Network1, output_1, receiver1, receiver_defs::input>
+>;
+
+template<typename TIME>
+using ABPSimulator1 = cadmium::modeling::coupled_model<TIME, iports_ABPSimulator,
+    oports_ABPSimulator, submodels_ABPSimulator, eics_ABPSimulator,
+    eocs_ABPSimulator, ics_ABPSimulator>;
+
+/************************/
+/*******TOP MODEL********/
+/************************/
+using iports_TOP = std::tuple<>;
+using oports_TOP = std::tuple<output_pack,output_acknowledge>;
+using submodels_TOP = cadmium::modeling::models_tuple<generator_con,ABPSimulator1>;
+using eics_TOP = std::tuple<>;
+using eocs_TOP = std::tuple<
+    cadmium::modeling::EOC<ABPSimulator1, output_pack, output_pack>,
+    cadmium::modeling::EOC<ABPSimulator1, output_pack, output_acknowledge>
+>;
+using ics_TOP = std::tuple<
+    cadmium::modeling::IC<generator_con, iestream_input_defs<message_t>::out,
+    ABPSimulator1, input_control>
+>;
+
+template<typename TIME>
+using abp_static_top = cadmium::modeling::coupled_model<TIME, iports_TOP,
+    oports_TOP, submodels_TOP, eics_TOP, eocs_TOP, ics_TOP>;
+
+#endif // _ABP_STATIC_HPP_
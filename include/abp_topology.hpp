@@ -0,0 +1,466 @@
+/**
+ * \brief Builder for the ABP top model with a configurable number of links.
+ *
+ * The top model holds one application generator (generator_con) which feeds
+ * K independent ABPSimulator coupled models. Every ABPSimulator has its own
+ * Sender, Receiver and Network, and every Network has its own two Subnets.
+ * Atomic models are numbered per link so that their lines can still be told
+ * apart by output_filter:
+ *
+ *   link 1 : sender1, receiver1, subnet1, subnet2
+ *   link 2 : sender2, receiver2, subnet3, subnet4
+ *   link k : sender<k>, receiver<k>, subnet<2k-1>, subnet<2k>
+ *
+ * The coupled models are named Network<k> and ABPSimulator<k>. Port types are
+ * shared by all links, which is fine because a port is only looked up inside
+ * the coupled model that declares it.
+ *
+ * Every Subnet gets its own seed derived from the run seed and the subnet
+ * number, so two runs with different seeds are independent replications.
+ * All the Subnets use the delay and loss models given by one channel_config.
+ *
+ * The Sender and Receiver of every link follow one protocol_config:
+ *
+ *   abp                         alternating bit, Sender and Receiver
+ *   gbn:WINDOW                  Go-Back-N, GbnSender and GbnReceiver
+ *   sr:WINDOW                   Selective Repeat, SrSender and SrReceiver
+ *
+ * With adaptive_timeout the abp Sender computes its timeout from the round
+ * trip times (rto_estimator.hpp) instead of using its fixed timeout. The
+ * preparation times and the timeout of every protocol can be changed in
+ * protocol_config, they default to the constants of the models.
+ *
+ * The sliding window models use the same ports, so the couplings do not
+ * depend on the protocol.
+ *
+ * The atomic models are built with make_abp_atomic_model and counted and
+ * timed when the simulator is built with ABP_INSTRUMENTATION (see
+ * instrumented_model.hpp). When make_abp_top is given a checkpoint
+ * registry, the models are also registered in it so they can be written
+ * to a checkpoint and restored (checkpoint.hpp; the sliding window models
+ * cannot); without one they are the models themselves.
+ *
+ * reset_abp_top puts the models of the registry of a top model back to
+ * their initial state with the subnet seeds of a new run seed, so
+ * back-to-back replications reuse one model graph instead of building a
+ * new one each.
+ */
+
+#ifndef _ABP_TOPOLOGY_HPP_
+#define _ABP_TOPOLOGY_HPP_
+
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+
+#include "message.hpp"
+#include "packet.hpp"
+#include "receiver_cadmium.hpp"
+#include "sender_cadmium.hpp"
+#include "subnet_cadmium.hpp"
+#include "gbn_cadmium.hpp"
+#include "sr_cadmium.hpp"
+#include "channel_model.hpp"
+#include "time_conversion.hpp"
+#include "instrumented_model.hpp"
+#include "checkpoint.hpp"
+#include "../lib/vendor/include/iestream.hpp"
+
+/***** SETING INPUT PORTS FOR COUPLEDs *****/
+struct input_control : public cadmium::in_port<message_t>{};
+struct input_1 : public cadmium::in_port<packet_t>{};
+struct input_2 : public cadmium::in_port<packet_t>{};
+
+/***** SETING OUTPUT PORTS FOR COUPLEDs *****/
+struct output_acknowledge : public cadmium::out_port<message_t>{};
+struct output_1 : public cadmium::out_port<packet_t>{};
+struct output_2 : public cadmium::out_port<packet_t>{};
+struct output_pack : public cadmium::out_port<message_t>{};
+
+
+/********************************************/
+/****** APPLICATION GENERATOR *******************/
+/********************************************/
+template<typename T>
+class ApplicationGen : public iestream_input<message_t,T> {
+    public:
+    ApplicationGen() = default;
+    ApplicationGen(const char* file_path) : iestream_input<message_t,
+        T>(file_path) {}
+
+    /**
+     * Writes the position in the input file and the events about to be
+     * given to a checkpoint; the file itself is read again when the model
+     * is rebuilt.
+     * @param writer
+     */
+    void save_checkpoint(checkpoint_writer &writer) const {
+        writer.u64(this->state._parser.position());
+        writer.i64(this->state._last_input_read.value);
+        writer.u64(this->state._next_input.size());
+        for (const message_t &input : this->state._next_input) {
+            writer.i64(input.value);
+        }
+        writer.time(this->state._simulation_time);
+        writer.time(this->state._next_time);
+        writer.time(this->state._next_time2);
+        writer.boolean(this->state._initialization);
+    }
+
+    void load_checkpoint(checkpoint_reader &reader) {
+        this->state._parser.seek(reader.u64());
+        this->state._last_input_read.value = reader.i64();
+        this->state._next_input.resize(reader.u64());
+        for (message_t &input : this->state._next_input) {
+            input.value = reader.i64();
+        }
+        this->state._simulation_time = reader.time<T>();
+        this->state._next_time = reader.time<T>();
+        this->state._next_time2 = reader.time<T>();
+        this->state._initialization = reader.boolean();
+    }
+};
+
+/**
+ * Builds an atomic model of the top model: it is counted and timed with
+ * ABP_INSTRUMENTATION, and it can be checkpointed (see checkpoint.hpp) when
+ * a registry is given.
+ * @param registry registry of the top model, null when it is not
+ * checkpointed
+ * @param id model id
+ * @param args arguments of the constructor of ATOMIC
+ * @return the model
+ */
+
+template<template<typename> class ATOMIC, typename TIME, typename... Args>
+std::shared_ptr<cadmium::dynamic::modeling::model>
+make_abp_atomic_model(const std::shared_ptr<checkpoint_registry<TIME>> &registry,
+    const std::string &id, Args&&... args){
+    if(!registry){
+        return make_instrumented_atomic_model<ATOMIC, TIME, Args...>(id,
+            std::forward<Args>(args)...);
+    }
+    return make_instrumented_atomic_model<checkpointable<ATOMIC>::template model,
+        TIME, std::shared_ptr<checkpoint_registry<TIME>>, std::string, Args...>(id,
+        std::shared_ptr<checkpoint_registry<TIME>>(registry), std::string(id),
+        std::forward<Args>(args)...);
+}
+
+/**
+ * Builds the name of a model that belongs to a link, e.g. ("sender", 2)
+ * gives "sender2".
+ * @param base name of the model without number
+ * @param number link (or subnet) number starting at 1
+ * @return the numbered model name
+ */
+
+inline std::string link_model_name(const char *base, int number){
+    return std::string(base) + std::to_string(number);
+}
+
+/**
+ * Derives the seed of one subnet from the seed of the run, so that subnets
+ * of the same run and the same subnet in different runs get unrelated
+ * random numbers (splitmix64 finalizer).
+ * @param seed seed of the whole run
+ * @param subnet subnet number starting at 1
+ * @return seed for that subnet
+ */
+
+inline unsigned int subnet_seed(unsigned int seed, int subnet){
+    unsigned long long z = (static_cast<unsigned long long>(seed) << 32) +
+        static_cast<unsigned long long>(subnet) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<unsigned int>(z ^ (z >> 31));
+}
+
+/**
+ * Protocol of the Sender and Receiver of every link.
+ */
+
+struct protocol_config{
+    std::string name = "abp";   /**<abp, gbn or sr*/
+    uint32_t window = 1;        /**<window of gbn and sr*/
+    bool adaptive_timeout = false;  /**<Jacobson/Karels timeout of abp*/
+    /**<filled by the abp Senders of every link, can be empty*/
+    std::shared_ptr<sender_statistics> statistics;
+    double sender_preparation = 10;     /**<PREPARATION_TIME of the senders (s)*/
+    double timeout = 20;                /**<timeout of the senders (s)*/
+    double receiver_preparation = 10;   /**<PREPARATION_TIME of the receivers (s)*/
+};
+
+/**
+ * Reads a protocol description such as "gbn:8".
+ * @param spec abp, gbn:WINDOW or sr:WINDOW
+ * @return the protocol
+ */
+
+inline protocol_config parse_protocol(const std::string &spec){
+    protocol_config protocol;
+    const size_t colon = spec.find(':');
+    protocol.name = spec.substr(0, colon);
+    if(protocol.name != "abp" && protocol.name != "gbn" && protocol.name != "sr"){
+        throw std::invalid_argument("unknown protocol " + spec);
+    }
+    if(colon == std::string::npos){
+        if(protocol.name != "abp"){
+            throw std::invalid_argument("missing window in protocol " + spec);
+        }
+        return protocol;
+    }
+    if(protocol.name == "abp"){
+        throw std::invalid_argument("abp takes no window in protocol " + spec);
+    }
+    // stoll, so that a negative window is not wrapped around
+    const std::string text = spec.substr(colon + 1);
+    size_t used = 0;
+    const long long window = std::stoll(text, &used);
+    if(used != text.size() || window < 1 ||
+        window > std::numeric_limits<uint32_t>::max()){
+        throw std::invalid_argument("the window should be between 1 and " +
+            std::to_string(std::numeric_limits<uint32_t>::max()) + " in " + spec);
+    }
+    protocol.window = static_cast<uint32_t>(window);
+    return protocol;
+}
+
+/**
+ * This function builds one ABPSimulator coupled model, i.e. one Sender and
+ * one Receiver talking through a Network made of two Subnets.
+ * @param link number of the link starting at 1
+ * @param seed seed of the run
+ * @param channel delay and loss models of the subnets
+ * @param payload_length payload bytes of every data packet
+ * @param protocol protocol of the sender and the receiver
+ * @param registry checkpoint registry of the top model, can be null
+ * @return the ABPSimulator<link> coupled model
+ */
+
+template<typename TIME>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>
+make_abp_link(int link, unsigned int seed, const channel_config &channel,
+    uint32_t payload_length = 0,
+    const protocol_config &protocol = protocol_config(),
+    const std::shared_ptr<checkpoint_registry<TIME>> &registry = nullptr){
+
+    const std::string sender_name = link_model_name("sender", link);
+    const std::string receiver_name = link_model_name("receiver", link);
+    const std::string subnet_data_name = link_model_name("subnet", 2*link-1);
+    const std::string subnet_ack_name = link_model_name("subnet", 2*link);
+    const std::string network_name = link_model_name("Network", link);
+
+/********************************************/
+/****** SENDER, RECEIVER AND SUBNETS *******************/
+/********************************************/
+    std::shared_ptr<cadmium::dynamic::modeling::model> sender;
+    std::shared_ptr<cadmium::dynamic::modeling::model> receiver;
+    const TIME sender_preparation =
+        seconds_to_time<TIME>(protocol.sender_preparation);
+    const TIME timeout = seconds_to_time<TIME>(protocol.timeout);
+    const TIME receiver_preparation =
+        seconds_to_time<TIME>(protocol.receiver_preparation);
+    if(protocol.name == "gbn"){
+        sender = make_abp_atomic_model<GbnSender, TIME, uint32_t,
+        uint32_t, TIME, TIME>(registry, sender_name, uint32_t(protocol.window),
+        uint32_t(payload_length), TIME(sender_preparation), TIME(timeout));
+        receiver = make_abp_atomic_model<GbnReceiver,
+        TIME, TIME>(registry, receiver_name, TIME(receiver_preparation));
+    }else if(protocol.name == "sr"){
+        sender = make_abp_atomic_model<SrSender, TIME, uint32_t,
+        uint32_t, TIME, TIME>(registry, sender_name, uint32_t(protocol.window),
+        uint32_t(payload_length), TIME(sender_preparation), TIME(timeout));
+        receiver = make_abp_atomic_model<SrReceiver, TIME,
+        uint32_t, TIME>(registry, receiver_name, uint32_t(protocol.window),
+        TIME(receiver_preparation));
+    }else{
+        sender = make_abp_atomic_model<Sender, TIME, uint32_t, bool,
+        std::shared_ptr<sender_statistics>, TIME, TIME>(registry, sender_name,
+        uint32_t(payload_length), bool(protocol.adaptive_timeout),
+        std::shared_ptr<sender_statistics>(protocol.statistics),
+        TIME(sender_preparation), TIME(timeout));
+        receiver = make_abp_atomic_model<Receiver,
+        TIME, TIME>(registry, receiver_name, TIME(receiver_preparation));
+    }
+    std::shared_ptr<cadmium::dynamic::modeling::model> subnet_data =
+    make_abp_atomic_model<Subnet,
+    TIME, channel_config, unsigned int>(registry, subnet_data_name,
+    channel_config(channel), subnet_seed(seed, 2*link-1));
+    std::shared_ptr<cadmium::dynamic::modeling::model> subnet_ack =
+    make_abp_atomic_model<Subnet,
+    TIME, channel_config, unsigned int>(registry, subnet_ack_name,
+    channel_config(channel), subnet_seed(seed, 2*link));
+
+/************************/
+/*******NETWORK********/
+/************************/
+    cadmium::dynamic::modeling::Ports iports_Network = {
+        typeid(input_1),typeid(input_2)
+    };
+    cadmium::dynamic::modeling::Ports oports_Network = {
+        typeid(output_1),typeid(output_2)
+    };
+    cadmium::dynamic::modeling::Models submodels_Network = {
+        subnet_data, subnet_ack
+    };
+    cadmium::dynamic::modeling::EICs eics_Network = {
+        cadmium::dynamic::translate::make_EIC<input_1,
+        subnet_defs::input>(subnet_data_name),
+        cadmium::dynamic::translate::make_EIC<input_2,
+        subnet_defs::input>(subnet_ack_name)
+    };
+    cadmium::dynamic::modeling::EOCs eocs_Network = {
+        cadmium::dynamic::translate::make_EOC<subnet_defs::output,
+        output_1>(subnet_data_name),
+        cadmium::dynamic::translate::make_EOC<subnet_defs::output,
+        output_2>(subnet_ack_name)
+    };
+    cadmium::dynamic::modeling::ICs ics_Network = {};
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> NETWORK =
+    std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        network_name,
+        submodels_Network,
+        iports_Network,
+        oports_Network,
+        eics_Network,
+        eocs_Network,
+        ics_Network
+    );
+
+/************************/
+/*******ABPSimulator********/
+/************************/
+    cadmium::dynamic::modeling::Ports iports_ABPSimulator = {
+        typeid(input_control)
+    };
+    cadmium::dynamic::modeling::Ports oports_ABPSimulator ={
+        typeid(output_acknowledge),typeid(output_pack)
+    };
+    cadmium::dynamic::modeling::Models submodels_ABPSimulator = {
+        sender,receiver,NETWORK
+    };
+    cadmium::dynamic::modeling::EICs eics_ABPSimulator = {
+        cadmium::dynamic::translate::make_EIC<input_control,
+        sender_defs::control_in>(sender_name)
+    };
+    cadmium::dynamic::modeling::EOCs eocs_ABPSimulator = {
+        cadmium::dynamic::translate::make_EOC<sender_defs::packet_sent_out,
+        output_pack>(sender_name),
+        cadmium::dynamic::translate::make_EOC<sender_defs::ack_received_out,
+        output_acknowledge>(sender_name)
+    };
+    cadmium::dynamic::modeling::ICs ics_ABPSimulator = {
+        cadmium::dynamic::translate::make_IC<sender_defs::data_out,
+        input_1>(sender_name,network_name),
+        cadmium::dynamic::translate::make_IC<output_2,
+        sender_defs::ack_in>(network_name,sender_name),
+        cadmium::dynamic::translate::make_IC<receiver_defs::output,
+        input_2>(receiver_name,network_name),
+        cadmium::dynamic::translate::make_IC<output_1,
+        receiver_defs::input>(network_name,receiver_name)
+    };
+    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        link_model_name("ABPSimulator", link),
+        submodels_ABPSimulator,
+        iports_ABPSimulator,
+        oports_ABPSimulator,
+        eics_ABPSimulator,
+        eocs_ABPSimulator,
+        ics_ABPSimulator
+    );
+}
+
+/**
+ * This function builds the TOP coupled model with one generator_con that
+ * reads the control file and drives every link at the same time.
+ * @param p_input_data_control path to the control input file
+ * @param links number of independent ABPSimulator links (at least 1)
+ * @param seed seed of the run, used to seed every Subnet
+ * @param channel delay and loss models of the subnets
+ * @param payload_length payload bytes of every data packet (0 for none)
+ * @param protocol protocol of the senders and the receivers
+ * @param registry receives the models for write_checkpoint,
+ * read_checkpoint and reset_abp_top, null when the top model is neither
+ * checkpointed nor reset
+ * @return the TOP coupled model
+ */
+
+template<typename TIME>
+std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>
+make_abp_top(const char *p_input_data_control, int links,
+    unsigned int seed = 0, const channel_config &channel = channel_config(),
+    uint32_t payload_length = 0,
+    const protocol_config &protocol = protocol_config(),
+    const std::shared_ptr<checkpoint_registry<TIME>> &registry = nullptr){
+
+    std::shared_ptr<cadmium::dynamic::modeling::model> generator_con =
+    make_abp_atomic_model<ApplicationGen,
+    TIME,const char* >(registry, "generator_con",
+        std::move(p_input_data_control));
+
+/************************/
+/*******TOP MODEL********/
+/************************/
+    cadmium::dynamic::modeling::Ports iports_TOP = {};
+    cadmium::dynamic::modeling::Ports oports_TOP = {
+        typeid(output_pack),typeid(output_acknowledge)
+    };
+    cadmium::dynamic::modeling::Models submodels_TOP = {generator_con};
+    cadmium::dynamic::modeling::EICs eics_TOP = {};
+    cadmium::dynamic::modeling::EOCs eocs_TOP = {};
+    cadmium::dynamic::modeling::ICs ics_TOP = {};
+
+    for(int link = 1; link <= links; link++){
+        const std::string abp_name = link_model_name("ABPSimulator", link);
+        submodels_TOP.push_back(make_abp_link<TIME>(link, seed, channel,
+            payload_length, protocol, registry));
+        eocs_TOP.push_back(
+            cadmium::dynamic::translate::make_EOC<output_pack,
+            output_pack>(abp_name));
+        eocs_TOP.push_back(
+            cadmium::dynamic::translate::make_EOC<output_pack,
+            output_acknowledge>(abp_name));
+        ics_TOP.push_back(
+            cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
+            input_control>("generator_con",abp_name));
+    }
+
+    return std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
+        "TOP",
+        submodels_TOP,
+        iports_TOP,
+        oports_TOP,
+        eics_TOP,
+        eocs_TOP,
+        ics_TOP
+    );
+}
+
+/**
+ * Resets the models of a top model, so the next run gives the log of a top
+ * model built with the new seed: the generator goes back to the first
+ * event of its file, the senders and the receivers to their initial state
+ * and every subnet draws the random numbers of subnet_seed(seed, subnet).
+ * @param registry registry given to make_abp_top
+ * @param seed seed of the next run
+ */
+
+template<typename TIME>
+void reset_abp_top(checkpoint_registry<TIME> &registry, unsigned int seed){
+    reset_models<TIME>(registry, [seed](const std::string &id){
+        if(id.rfind("subnet", 0) == 0){
+            return subnet_seed(seed, std::stoi(id.substr(6)));
+        }
+        return seed;
+    });
+}
+
+#endif // _ABP_TOPOLOGY_HPP_
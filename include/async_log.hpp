@@ -0,0 +1,168 @@
+/**
+ * \brief log sink that writes the log on a background thread.
+ *
+ * The loggers write to a std::ostream from inside the simulation loop, so
+ * with a std::ofstream every stall of the disk stalls the simulation.
+ * async_log_streambuf only copies the log into memory on the simulation
+ * thread: the lines are gathered in a local buffer and whole lines are
+ * pushed into a single producer, single consumer ring buffer (no lock, one
+ * atomic store per batch). A writer thread takes them out of the ring and
+ * writes them to the file in large writes.
+ *
+ * When the ring is full the simulation thread either waits for the writer
+ * (block, no line is lost) or drops the lines that do not fit (drop, the
+ * simulation never waits for the disk). With block a maximum wait can be
+ * given, after which the lines that still do not fit are dropped. A line
+ * is written whole or dropped whole, unless it is longer than the batch.
+ * The time spent waiting and what was dropped are counted
+ * (async_log_statistics).
+ *
+ * The flushes of the loggers (std::endl) do not wait for the writer; the
+ * file is complete once flush() or close() returns.
+ */
+
+#ifndef _ASYNC_LOG_HPP_
+#define _ASYNC_LOG_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * What the simulation thread does when the ring is full.
+ */
+
+enum class async_log_policy{
+    block,      /**<waits for the writer, up to max_block_seconds if set*/
+    drop        /**<drops the lines that do not fit*/
+};
+
+/**
+ * Parameters of an async_log_streambuf.
+ */
+
+struct async_log_config{
+    size_t capacity = 1 << 24;          /**<bytes of the ring, a power of two*/
+    size_t write_size = 1 << 20;        /**<bytes written at once by the writer*/
+    size_t batch_size = 1 << 16;        /**<bytes gathered before a push*/
+    async_log_policy policy = async_log_policy::block;
+    double max_block_seconds = 0;       /**<longest wait of a push, 0 for none*/
+    double max_latency_seconds = 0.05;  /**<longest time a line stays in memory*/
+};
+
+/**
+ * What the sink did, read once it is closed.
+ */
+
+struct async_log_statistics{
+    uint64_t bytes_written = 0;
+    uint64_t writes = 0;                /**<write calls of the writer*/
+    uint64_t lines_dropped = 0;
+    uint64_t bytes_dropped = 0;
+    uint64_t blocks = 0;                /**<pushes that had to wait*/
+    double blocked_seconds = 0;         /**<simulation time spent waiting*/
+    uint64_t peak_bytes = 0;            /**<most bytes in the ring at once*/
+
+    /**
+     * Writes a summary of the statistics.
+     * @param os
+     */
+    void print(std::ostream &os) const;
+};
+
+/**
+ * Reads a policy description: block, block:SECONDS or drop.
+ * @param spec
+ * @param config receives the policy and the maximum wait
+ */
+
+void parse_async_log_policy(const std::string &spec, async_log_config &config);
+
+class async_log_streambuf : public std::streambuf{
+    public:
+    async_log_streambuf() = default;
+    ~async_log_streambuf();
+
+    async_log_streambuf(const async_log_streambuf&) = delete;
+    async_log_streambuf& operator=(const async_log_streambuf&) = delete;
+
+    /**
+     * Opens the log file and starts the writer thread.
+     * @param path log file
+     * @param config sizes and policy, a capacity that is not a power of
+     * two is rounded up
+     * @return false if the file cannot be opened
+     */
+    bool open(const char *path, const async_log_config &config = async_log_config());
+
+    /**
+     * Pushes the lines gathered and waits until the writer wrote every line
+     * pushed, a line that is not ended yet stays in the sink.
+     */
+    void flush();
+
+    /**
+     * Pushes everything left, stops the writer and closes the file. Called
+     * by the destructor if needed.
+     */
+    void close();
+
+    const async_log_statistics& statistics() const{
+        return stats;
+    }
+
+    protected:
+    int_type overflow(int_type c) override;
+
+    /**
+     * Called on every std::endl of the loggers, it only pushes the lines
+     * gathered when the last push is max_latency_seconds old.
+     */
+    int sync() override;
+
+    private:
+    /**
+     * Pushes the complete lines of the batch, the end of an unfinished line
+     * is kept.
+     * @param all pushes the unfinished line too
+     */
+    void push_batch(bool all);
+
+    /**
+     * Copies bytes into the ring following the policy.
+     */
+    void push(const char *data, size_t size);
+
+    /**
+     * Loop of the writer thread.
+     */
+    void write_loop();
+
+    FILE *file = nullptr;
+    async_log_config config;
+    async_log_statistics stats;
+    std::vector<char> ring;
+    size_t mask = 0;
+    std::vector<char> batch;
+    std::chrono::steady_clock::time_point last_push;
+    /**<bytes pushed, written by the simulation thread only*/
+    alignas(64) std::atomic<uint64_t> head{0};
+    /**<bytes written to the file, written by the writer thread only*/
+    alignas(64) std::atomic<uint64_t> tail{0};
+    alignas(64) std::atomic<bool> flush_requested{false};
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+    /**<set by the writer, read once it has stopped*/
+    uint64_t bytes_written = 0;
+    uint64_t writes = 0;
+    bool write_failed = false;
+};
+
+#endif // _ASYNC_LOG_HPP_
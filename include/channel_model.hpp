@@ -0,0 +1,639 @@
+/**
+ * \brief delay and loss models used by the Subnet.
+ *
+ * A channel is made of one delay model, which tells how long a packet
+ * takes to cross the subnet, and one loss model, which tells whether the
+ * packet is lost on the way. Every model owns its own seeded random engine
+ * and its distribution object, both built once when the subnet is built.
+ * Samples are produced in batches, so taking one sample in a transition is
+ * only reading the next value of a buffer. The engines, the distributions
+ * and the batches can be written to a checkpoint and read back
+ * (save_checkpoint and load_checkpoint), so a restored subnet draws the
+ * same samples as the one that was stopped.
+ *
+ * Delays (in seconds):
+ *   normal:MEAN:STDDEV          normal delay, negative samples become 0,
+ *                               STDDEV > 0
+ *   exponential:MEAN            exponential delay, MEAN > 0
+ *   uniform:MIN:MAX             uniform delay, 0 <= MIN <= MAX
+ *   empirical:V1,V2,...         inverse CDF of the observed delays
+ *   empirical:PATH              same with the observed delays read from a file
+ *
+ * Losses:
+ *   bernoulli:P                 every packet is lost with probability P
+ *   gilbert:PGB:PBG:LG:LB       Gilbert-Elliott two state burst loss, PGB and
+ *                               PBG are the good->bad and bad->good
+ *                               probabilities, LG and LB the loss
+ *                               probabilities in each state
+ *
+ * Every probability is between 0 and 1; a description that does not fit
+ * its model throws std::invalid_argument.
+ */
+
+#ifndef _CHANNEL_MODEL_HPP_
+#define _CHANNEL_MODEL_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**<number of samples drawn at once by every model*/
+static constexpr size_t CHANNEL_BATCH_SIZE = 256;
+
+/**
+ * Writes a batch of samples and the position of the next one.
+ * @param writer checkpoint writer (see checkpoint.hpp)
+ * @param batch
+ * @param cursor
+ */
+
+template<typename WRITER>
+void save_batch(WRITER &writer, const std::vector<double> &batch, size_t cursor){
+    writer.u64(batch.size());
+    for(double sample : batch){
+        writer.f64(sample);
+    }
+    writer.u64(cursor);
+}
+
+/**
+ * Reads what save_batch wrote.
+ * @param reader checkpoint reader
+ * @param batch
+ * @param cursor
+ */
+
+template<typename READER>
+void load_batch(READER &reader, std::vector<double> &batch, size_t &cursor){
+    batch.resize(reader.u64());
+    for(double &sample : batch){
+        sample = reader.f64();
+    }
+    cursor = reader.u64();
+    reader.check(cursor <= batch.size(), "batch");
+}
+
+/**
+ * Base class of the delay models. It keeps a batch of delays and refills it
+ * when it is used up.
+ */
+
+class delay_model{
+    public:
+    virtual ~delay_model() = default;
+
+    /**
+     * @return the delay of the next packet in seconds
+     */
+    double next_delay(){
+        if(cursor == batch.size()){
+            batch.resize(CHANNEL_BATCH_SIZE);
+            fill(batch);
+            cursor = 0;
+        }
+        return batch[cursor++];
+    }
+
+    /**
+     * Seeds the engine and drops the samples that were already drawn and
+     * the state of the distribution.
+     * @param seed new seed
+     */
+    void seed(unsigned int seed){
+        generator.seed(seed);
+        reset_distribution();
+        batch.clear();
+        cursor = 0;
+    }
+
+    virtual std::unique_ptr<delay_model> clone() const = 0;
+
+    /**
+     * Writes the engine, the distribution and the samples not used yet to
+     * a checkpoint (see checkpoint.hpp).
+     * @param writer
+     */
+    template<typename WRITER>
+    void save_checkpoint(WRITER &writer) const{
+        writer.stream() << generator << ' ';
+        save_distribution(writer.stream());
+        save_batch(writer, batch, cursor);
+    }
+
+    /**
+     * Reads what save_checkpoint wrote.
+     * @param reader
+     */
+    template<typename READER>
+    void load_checkpoint(READER &reader){
+        reader.check(static_cast<bool>(reader.stream() >> generator), "engine");
+        reader.check(load_distribution(reader.stream()), "distribution");
+        load_batch(reader, batch, cursor);
+    }
+
+    protected:
+    /**<fills the whole batch with new samples*/
+    virtual void fill(std::vector<double> &samples) = 0;
+
+    /**<distributions that keep state between two samples write it here*/
+    virtual void save_distribution(std::ostream &) const{}
+    virtual bool load_distribution(std::istream &){
+        return true;
+    }
+    virtual void reset_distribution(){}
+
+    std::mt19937_64 generator;
+
+    private:
+    std::vector<double> batch;
+    size_t cursor = 0;
+};
+
+/**
+ * Base class of the loss models. The batch holds uniform numbers in [0,1)
+ * that the model turns into loss decisions.
+ */
+
+class loss_model{
+    public:
+    virtual ~loss_model() = default;
+
+    /**
+     * @return true if the next packet is lost
+     */
+    virtual bool next_lost() = 0;
+
+    /**
+     * Seeds the engine and drops the numbers that were already drawn and
+     * the state of the model.
+     * @param seed new seed
+     */
+    void seed(unsigned int seed){
+        generator.seed(seed);
+        reset_model();
+        batch.clear();
+        cursor = 0;
+    }
+
+    virtual std::unique_ptr<loss_model> clone() const = 0;
+
+    /**
+     * Writes the engine, the state of the model and the numbers not used
+     * yet to a checkpoint (see checkpoint.hpp).
+     * @param writer
+     */
+    template<typename WRITER>
+    void save_checkpoint(WRITER &writer) const{
+        writer.stream() << generator << ' ';
+        save_model(writer.stream());
+        save_batch(writer, batch, cursor);
+    }
+
+    /**
+     * Reads what save_checkpoint wrote.
+     * @param reader
+     */
+    template<typename READER>
+    void load_checkpoint(READER &reader){
+        reader.check(static_cast<bool>(reader.stream() >> generator), "engine");
+        reader.check(load_model(reader.stream()), "loss model");
+        load_batch(reader, batch, cursor);
+    }
+
+    protected:
+    /**<models with a state of their own write it here*/
+    virtual void save_model(std::ostream &) const{}
+    virtual bool load_model(std::istream &){
+        return true;
+    }
+    virtual void reset_model(){}
+
+    /**
+     * @return the next uniform number of the batch
+     */
+    double next_uniform(){
+        if(cursor == batch.size()){
+            batch.resize(CHANNEL_BATCH_SIZE);
+            for(double &u : batch){
+                u = uniform(generator);
+            }
+            cursor = 0;
+        }
+        return batch[cursor++];
+    }
+
+    std::mt19937_64 generator;
+
+    private:
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    std::vector<double> batch;
+    size_t cursor = 0;
+};
+
+/*******************************************/
+/**************** delays *******************/
+/*******************************************/
+
+class normal_delay : public delay_model{
+    public:
+    normal_delay(double mean, double std_dev) : distribution(mean, std_dev){}
+
+    std::unique_ptr<delay_model> clone() const override{
+        return std::make_unique<normal_delay>(*this);
+    }
+
+    protected:
+    void fill(std::vector<double> &samples) override{
+        for(double &x : samples){
+            x = std::max(0.0, distribution(generator));
+        }
+    }
+
+    // the distribution keeps the second sample of every pair it draws
+    void save_distribution(std::ostream &os) const override{
+        os << distribution << ' ';
+    }
+
+    bool load_distribution(std::istream &is) override{
+        return static_cast<bool>(is >> distribution);
+    }
+
+    void reset_distribution() override{
+        distribution.reset();
+    }
+
+    private:
+    std::normal_distribution<double> distribution;
+};
+
+class exponential_delay : public delay_model{
+    public:
+    explicit exponential_delay(double mean) : distribution(1.0 / mean){}
+
+    std::unique_ptr<delay_model> clone() const override{
+        return std::make_unique<exponential_delay>(*this);
+    }
+
+    protected:
+    void fill(std::vector<double> &samples) override{
+        for(double &x : samples){
+            x = distribution(generator);
+        }
+    }
+
+    private:
+    std::exponential_distribution<double> distribution;
+};
+
+class uniform_delay : public delay_model{
+    public:
+    uniform_delay(double min, double max) : distribution(min, max){}
+
+    std::unique_ptr<delay_model> clone() const override{
+        return std::make_unique<uniform_delay>(*this);
+    }
+
+    protected:
+    void fill(std::vector<double> &samples) override{
+        for(double &x : samples){
+            x = distribution(generator);
+        }
+    }
+
+    private:
+    std::uniform_real_distribution<double> distribution;
+};
+
+/**
+ * Delays taken from observed values. The observed values are sorted once
+ * and the delays are drawn with the linear interpolation of their inverse
+ * cumulative distribution.
+ */
+
+class empirical_delay : public delay_model{
+    public:
+    explicit empirical_delay(std::vector<double> observed)
+        : values(std::move(observed)){
+        if(values.empty()){
+            throw std::invalid_argument("empirical delay without values");
+        }
+        std::sort(values.begin(), values.end());
+    }
+
+    std::unique_ptr<delay_model> clone() const override{
+        return std::make_unique<empirical_delay>(*this);
+    }
+
+    protected:
+    void fill(std::vector<double> &samples) override{
+        const double last = static_cast<double>(values.size() - 1);
+        for(double &x : samples){
+            double position = uniform(generator) * last;
+            size_t below = static_cast<size_t>(position);
+            if(below >= values.size() - 1){
+                x = values.back();
+            }else{
+                double fraction = position - below;
+                x = values[below] + fraction * (values[below + 1] - values[below]);
+            }
+        }
+    }
+
+    private:
+    std::vector<double> values;
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+};
+
+/*******************************************/
+/**************** losses *******************/
+/*******************************************/
+
+class bernoulli_loss : public loss_model{
+    public:
+    explicit bernoulli_loss(double probability) : loss_probability(probability){}
+
+    bool next_lost() override{
+        return next_uniform() < loss_probability;
+    }
+
+    std::unique_ptr<loss_model> clone() const override{
+        return std::make_unique<bernoulli_loss>(*this);
+    }
+
+    private:
+    double loss_probability;
+};
+
+/**
+ * Gilbert-Elliott channel: a two state Markov chain (good and bad) where
+ * each state has its own loss probability, which gives bursts of losses.
+ */
+
+class gilbert_elliott_loss : public loss_model{
+    public:
+    gilbert_elliott_loss(double good_to_bad, double bad_to_good,
+        double loss_good, double loss_bad)
+        : p_good_to_bad(good_to_bad), p_bad_to_good(bad_to_good),
+          loss_in_good(loss_good), loss_in_bad(loss_bad){}
+
+    bool next_lost() override{
+        if(bad){
+            bad = !(next_uniform() < p_bad_to_good);
+        }else{
+            bad = next_uniform() < p_good_to_bad;
+        }
+        return next_uniform() < (bad ? loss_in_bad : loss_in_good);
+    }
+
+    std::unique_ptr<loss_model> clone() const override{
+        return std::make_unique<gilbert_elliott_loss>(*this);
+    }
+
+    protected:
+    void save_model(std::ostream &os) const override{
+        os << bad << ' ';
+    }
+
+    bool load_model(std::istream &is) override{
+        return static_cast<bool>(is >> bad);
+    }
+
+    void reset_model() override{
+        bad = false;
+    }
+
+    private:
+    double p_good_to_bad;
+    double p_bad_to_good;
+    double loss_in_good;
+    double loss_in_bad;
+    bool bad = false;
+};
+
+/*******************************************/
+/**************** channel ******************/
+/*******************************************/
+
+/**
+ * Text description of a channel, e.g. delay "normal:3:1" and loss
+ * "bernoulli:0.05", which is the channel the Subnet always had.
+ */
+
+struct channel_config{
+    std::string delay = "normal:3:1";
+    std::string loss = "bernoulli:0.05";
+};
+
+/**
+ * Splits a model description on ':' (the first field is the model name).
+ * @param spec description such as "uniform:1:5"
+ * @return the fields
+ */
+
+inline std::vector<std::string> split_channel_spec(const std::string &spec){
+    std::vector<std::string> fields;
+    std::istringstream is(spec);
+    std::string field;
+    while(std::getline(is, field, ':')){
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+/**
+ * Reads the parameter number index of a model description.
+ * @param fields fields of the description
+ * @param index index of the parameter (1 is the first one)
+ * @return the value of the parameter
+ */
+
+inline double channel_parameter(const std::vector<std::string> &fields,
+    size_t index){
+    if(index >= fields.size()){
+        throw std::invalid_argument("missing parameter in channel model " +
+            (fields.empty() ? std::string() : fields[0]));
+    }
+    return std::stod(fields[index]);
+}
+
+/**
+ * Reads the parameter number index of a loss model description, which is
+ * a probability.
+ * @param fields fields of the description
+ * @param index index of the parameter (1 is the first one)
+ * @param spec whole description, for the error
+ * @return the probability
+ */
+
+inline double channel_probability(const std::vector<std::string> &fields,
+    size_t index, const std::string &spec){
+    const double probability = channel_parameter(fields, index);
+    if(!(probability >= 0 && probability <= 1)){
+        throw std::invalid_argument("invalid loss model " + spec +
+            ", the probabilities must be between 0 and 1");
+    }
+    return probability;
+}
+
+/**
+ * Reads the observed delays of an empirical model, either a comma
+ * separated list or a file with one delay per line.
+ * @param text list of delays or path to a file
+ * @return the observed delays
+ */
+
+inline std::vector<double> read_empirical_values(const std::string &text){
+    std::vector<double> values;
+    if(!text.empty() && ((text[0] >= '0' && text[0] <= '9') || text[0] == '.')){
+        std::istringstream is(text);
+        std::string value;
+        while(std::getline(is, value, ',')){
+            values.push_back(std::stod(value));
+        }
+    }else{
+        std::ifstream file(text);
+        if(!file){
+            throw std::invalid_argument("cannot open empirical delays " + text);
+        }
+        double value;
+        while(file >> value){
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+/**
+ * Builds a delay model from its description.
+ * @param spec description of the delay model
+ * @return the delay model
+ */
+
+inline std::unique_ptr<delay_model> make_delay_model(const std::string &spec){
+    std::vector<std::string> fields = split_channel_spec(spec);
+    const std::string name = fields.empty() ? std::string() : fields[0];
+    if(name == "normal"){
+        const double mean = channel_parameter(fields, 1);
+        const double std_dev = channel_parameter(fields, 2);
+        if(!std::isfinite(mean) || !(std_dev > 0) || !std::isfinite(std_dev)){
+            throw std::invalid_argument("invalid delay model " + spec +
+                ", the standard deviation must be positive");
+        }
+        return std::make_unique<normal_delay>(mean, std_dev);
+    }else if(name == "exponential"){
+        const double mean = channel_parameter(fields, 1);
+        if(!(mean > 0) || !std::isfinite(mean)){
+            throw std::invalid_argument("invalid delay model " + spec +
+                ", the mean must be positive");
+        }
+        return std::make_unique<exponential_delay>(mean);
+    }else if(name == "uniform"){
+        const double min = channel_parameter(fields, 1);
+        const double max = channel_parameter(fields, 2);
+        if(!(min >= 0) || !(min <= max) || !std::isfinite(max)){
+            throw std::invalid_argument("invalid delay model " + spec +
+                ", the bounds must be 0 <= MIN <= MAX");
+        }
+        return std::make_unique<uniform_delay>(min, max);
+    }else if(name == "empirical"){
+        const size_t start = spec.find(':');
+        return std::make_unique<empirical_delay>(read_empirical_values(
+            start == std::string::npos ? std::string() : spec.substr(start + 1)));
+    }
+    throw std::invalid_argument("unknown delay model " + spec);
+}
+
+/**
+ * Builds a loss model from its description.
+ * @param spec description of the loss model
+ * @return the loss model
+ */
+
+inline std::unique_ptr<loss_model> make_loss_model(const std::string &spec){
+    std::vector<std::string> fields = split_channel_spec(spec);
+    const std::string name = fields.empty() ? std::string() : fields[0];
+    if(name == "bernoulli"){
+        return std::make_unique<bernoulli_loss>(
+            channel_probability(fields, 1, spec));
+    }else if(name == "gilbert"){
+        return std::make_unique<gilbert_elliott_loss>(
+            channel_probability(fields, 1, spec), channel_probability(fields, 2, spec),
+            channel_probability(fields, 3, spec), channel_probability(fields, 4, spec));
+    }
+    throw std::invalid_argument("unknown loss model " + spec);
+}
+
+/**
+ * A delay model and a loss model owned by one subnet. Copying a channel
+ * copies its models and their random engines.
+ */
+
+class channel_model{
+    public:
+    channel_model() : channel_model(channel_config()){}
+
+    explicit channel_model(const channel_config &config, unsigned int seed = 1)
+        : delay(make_delay_model(config.delay)),
+          loss(make_loss_model(config.loss)){
+        this->seed(seed);
+    }
+
+    channel_model(const channel_model &other)
+        : delay(other.delay->clone()), loss(other.loss->clone()){}
+
+    channel_model& operator=(const channel_model &other){
+        delay = other.delay->clone();
+        loss = other.loss->clone();
+        return *this;
+    }
+
+    /**
+     * Seeds the delay and the loss models with different seeds, they then
+     * draw the samples of a channel built with that seed.
+     * @param seed seed of the channel
+     */
+    void seed(unsigned int seed){
+        std::seed_seq sequence{seed};
+        unsigned int seeds[2];
+        sequence.generate(seeds, seeds + 2);
+        delay->seed(seeds[0]);
+        loss->seed(seeds[1]);
+    }
+
+    double next_delay(){
+        return delay->next_delay();
+    }
+
+    bool next_lost(){
+        return loss->next_lost();
+    }
+
+    /**
+     * Writes the state of both random engines to a checkpoint, so a
+     * restored channel draws the same delays and losses.
+     * @param writer checkpoint writer (see checkpoint.hpp)
+     */
+    template<typename WRITER>
+    void save_checkpoint(WRITER &writer) const{
+        delay->save_checkpoint(writer);
+        loss->save_checkpoint(writer);
+    }
+
+    template<typename READER>
+    void load_checkpoint(READER &reader){
+        delay->load_checkpoint(reader);
+        loss->load_checkpoint(reader);
+    }
+
+    private:
+    std::unique_ptr<delay_model> delay;
+    std::unique_ptr<loss_model> loss;
+};
+
+#endif // _CHANNEL_MODEL_HPP_
@@ -0,0 +1,503 @@
+/**
+ * \brief checkpoint and restore of the state of the atomic models.
+ *
+ * A checkpoint is a text file holding the simulated time it was taken at
+ * and the state of every atomic model, in the order the models were built:
+ *
+ *   ABPCHECKPOINT 1
+ *   <time> <log offset>
+ *   <run data written by the caller>
+ *   <number of models>
+ *   <id> <time of the last transition> <state written by the model>
+ *   ...
+ *
+ * Numbers are written as decimal integers, doubles by their bits, so a
+ * restored model continues with exactly the same values. Every model with
+ * save_checkpoint(checkpoint_writer&) const and
+ * load_checkpoint(checkpoint_reader&) members can be checkpointed.
+ *
+ * checkpointable<MODEL>::model<TIME> derives from MODEL<TIME> and keeps the
+ * time of its last transition, which the runner does not give to the
+ * models. When a model is restored at time t the runner starts at t, so the
+ * model tells the runner the time left until its next internal transition
+ * and gets the time elapsed since its real last transition in its next
+ * external or confluence transition; the transitions after the restart are
+ * then the ones of the run that was not stopped.
+ *
+ * The builder of a top model that is checkpointed creates one
+ * checkpoint_registry and gives it to every checkpointable model, which
+ * registers itself under its model id; write_checkpoint() and
+ * read_checkpoint() go through the models of that registry, so several top
+ * models can live on one thread. A top model built without a registry is
+ * made of the models themselves and pays nothing for the checkpoints.
+ *
+ * The same registry puts the models back to the state they were built with
+ * (reset_models()), so one model graph can run many replications. A model
+ * is reset through its reset(unsigned int seed) member, which also seeds
+ * its random numbers again, or its reset() member.
+ */
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cadmium/modeling/message_bag.hpp>
+
+/**<first line of a checkpoint file*/
+#define CHECKPOINT_MAGIC "ABPCHECKPOINT"
+/**<format of the checkpoint files written*/
+static constexpr int CHECKPOINT_VERSION = 1;
+
+/**
+ * Writes the fields of a checkpoint, separated by spaces.
+ */
+
+class checkpoint_writer{
+    public:
+    explicit checkpoint_writer(std::ostream &os) : os(os){}
+
+    void u64(uint64_t value){
+        os << value << ' ';
+    }
+
+    void i64(int64_t value){
+        os << value << ' ';
+    }
+
+    void boolean(bool value){
+        os << (value ? 1 : 0) << ' ';
+    }
+
+    /**
+     * Writes the bits of a double, so it is read back exactly.
+     * @param value
+     */
+    void f64(double value){
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        u64(bits);
+    }
+
+    /**
+     * Writes a string as its length and its bytes.
+     * @param value
+     */
+    void text(const std::string &value){
+        os << value.size() << ' ' << value << ' ';
+    }
+
+    /**
+     * Writes a TIME in its text form, or "inf".
+     * @param time
+     */
+    template<typename TIME>
+    void time(const TIME &time){
+        if(time == std::numeric_limits<TIME>::infinity()){
+            os << "inf ";
+        }else{
+            os << time << ' ';
+        }
+    }
+
+    /**
+     * Stream of the checkpoint, for the objects of the standard library
+     * that write their own state (random engines and distributions).
+     */
+    std::ostream& stream(){
+        return os;
+    }
+
+    void end_line(){
+        os << '\n';
+    }
+
+    private:
+    std::ostream &os;
+};
+
+/**
+ * Reads the fields written by checkpoint_writer, a field that cannot be read
+ * throws std::runtime_error.
+ */
+
+class checkpoint_reader{
+    public:
+    explicit checkpoint_reader(std::istream &is) : is(is){}
+
+    uint64_t u64(){
+        uint64_t value;
+        check(static_cast<bool>(is >> value), "number");
+        return value;
+    }
+
+    int64_t i64(){
+        int64_t value;
+        check(static_cast<bool>(is >> value), "number");
+        return value;
+    }
+
+    bool boolean(){
+        return u64() != 0;
+    }
+
+    double f64(){
+        const uint64_t bits = u64();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string text(){
+        const uint64_t size = u64();
+        check(is.get() == ' ', "string");
+        std::string value(size, '\0');
+        if(size > 0){
+            check(static_cast<bool>(is.read(&value[0], size)), "string");
+        }
+        return value;
+    }
+
+    template<typename TIME>
+    TIME time(){
+        std::string text;
+        check(static_cast<bool>(is >> text), "time");
+        if(text == "inf"){
+            return std::numeric_limits<TIME>::infinity();
+        }
+        return TIME(text);
+    }
+
+    std::istream& stream(){
+        return is;
+    }
+
+    /**
+     * @param ok result of the last read
+     * @param what field read, for the message
+     */
+    void check(bool ok, const char *what){
+        if(!ok){
+            throw std::runtime_error(std::string("corrupt checkpoint, cannot read ") +
+                what);
+        }
+    }
+
+    private:
+    std::istream &is;
+};
+
+/**
+ * A model that can write its state to a checkpoint and read it back.
+ */
+
+template<typename TIME>
+class checkpoint_participant{
+    public:
+    virtual ~checkpoint_participant() = default;
+    virtual void save_state(checkpoint_writer &writer) const = 0;
+    /**
+     * @param reader
+     * @param now time of the checkpoint, the runner restarts at it
+     */
+    virtual void load_state(checkpoint_reader &reader, const TIME &now) = 0;
+    /**
+     * Puts back the state the model was built with.
+     * @param seed new seed of the random numbers of the model, if any
+     */
+    virtual void reset_state(unsigned int seed) = 0;
+};
+
+/**
+ * Models of one top model that can be checkpointed, in the order they were
+ * built. The models share the registry and leave it when destroyed.
+ */
+
+template<typename TIME>
+struct checkpoint_registry{
+    std::vector<std::pair<std::string, checkpoint_participant<TIME>*>> models;
+
+    void add(const std::string &id, checkpoint_participant<TIME> *model){
+        models.emplace_back(id, model);
+    }
+
+    void remove(checkpoint_participant<TIME> *model){
+        for(auto it = models.begin(); it != models.end(); ++it){
+            if(it->second == model){
+                models.erase(it);
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * Tells whether MODEL has save_checkpoint and load_checkpoint members.
+ */
+
+template<typename MODEL, typename = void>
+struct has_checkpoint : std::false_type{};
+
+template<typename MODEL>
+struct has_checkpoint<MODEL, std::void_t<
+    decltype(std::declval<const MODEL&>().save_checkpoint(
+        std::declval<checkpoint_writer&>())),
+    decltype(std::declval<MODEL&>().load_checkpoint(
+        std::declval<checkpoint_reader&>()))>> : std::true_type{};
+
+/**
+ * Tells whether MODEL has a reset() member, and a reset(unsigned int seed)
+ * member for the models with random numbers.
+ */
+
+template<typename MODEL, typename = void>
+struct has_reset : std::false_type{};
+
+template<typename MODEL>
+struct has_reset<MODEL, std::void_t<
+    decltype(std::declval<MODEL&>().reset())>> : std::true_type{};
+
+template<typename MODEL, typename = void>
+struct has_seeded_reset : std::false_type{};
+
+template<typename MODEL>
+struct has_seeded_reset<MODEL, std::void_t<
+    decltype(std::declval<MODEL&>().reset(0u))>> : std::true_type{};
+
+template<template<typename> class MODEL>
+struct checkpointable{
+    template<typename TIME>
+    class model : public MODEL<TIME>, public checkpoint_participant<TIME>{
+        using base = MODEL<TIME>;
+        public:
+        using typename base::input_ports;
+        using typename base::output_ports;
+
+        model() : model(nullptr, std::string()){}
+
+        /**
+         * @param registry registry of the top model, can be null
+         * @param id model id, the key of the model in the checkpoint
+         * @param args arguments of the constructor of MODEL
+         */
+        template<typename... Args>
+        model(std::shared_ptr<checkpoint_registry<TIME>> registry,
+            const std::string &id, Args&&... args)
+            : base(std::forward<Args>(args)...), registry(std::move(registry)){
+            if(this->registry){
+                this->registry->add(id, this);
+            }
+        }
+
+        model(const model&) = delete;
+        model& operator=(const model&) = delete;
+
+        ~model(){
+            if(registry){
+                registry->remove(this);
+            }
+        }
+
+        void internal_transition(){
+            last = last + base::time_advance();
+            resumed = false;
+            base::internal_transition();
+        }
+
+        void external_transition(TIME e,
+            typename cadmium::make_message_bags<input_ports>::type mbs){
+            e = elapsed(e);
+            last = last + e;
+            base::external_transition(e, std::move(mbs));
+        }
+
+        void confluence_transition(TIME e,
+            typename cadmium::make_message_bags<input_ports>::type mbs){
+            e = elapsed(e);
+            last = last + e;
+            base::confluence_transition(e, std::move(mbs));
+        }
+
+        TIME time_advance() const{
+            const TIME advance = base::time_advance();
+            if(!resumed || advance == std::numeric_limits<TIME>::infinity()){
+                return advance;
+            }
+            return advance - resume_elapsed;
+        }
+
+        void save_state(checkpoint_writer &writer) const override{
+            if constexpr (has_checkpoint<base>::value){
+                writer.time(last);
+                base::save_checkpoint(writer);
+            }else{
+                throw std::logic_error("this model cannot be checkpointed");
+            }
+        }
+
+        void load_state(checkpoint_reader &reader, const TIME &now) override{
+            if constexpr (has_checkpoint<base>::value){
+                last = reader.template time<TIME>();
+                base::load_checkpoint(reader);
+                resume_elapsed = now - last;
+                resumed = true;
+            }else{
+                throw std::logic_error("this model cannot be checkpointed");
+            }
+        }
+
+        void reset_state(unsigned int seed) override{
+            last = TIME();
+            resume_elapsed = TIME();
+            resumed = false;
+            if constexpr (has_seeded_reset<base>::value){
+                base::reset(seed);
+            }else if constexpr (has_reset<base>::value){
+                base::reset();
+            }else{
+                throw std::logic_error("this model cannot be reset");
+            }
+        }
+
+        private:
+        /**
+         * @param e time elapsed given by the runner
+         * @return time elapsed since the last transition of the model
+         */
+        TIME elapsed(const TIME &e){
+            if(!resumed){
+                return e;
+            }
+            resumed = false;
+            return e + resume_elapsed;
+        }
+
+        std::shared_ptr<checkpoint_registry<TIME>> registry;
+        TIME last = TIME();             /**<time of the last transition*/
+        TIME resume_elapsed = TIME();   /**<last transition to the restart*/
+        bool resumed = false;
+    };
+};
+
+/**
+ * Writes the state of the models of a registry. The file is written next
+ * to path and renamed, so a crash while writing keeps the previous
+ * checkpoint.
+ * @param registry models of the top model
+ * @param path checkpoint file
+ * @param now simulated time of the checkpoint, no event before it is pending
+ * @param log_offset bytes of the log written up to now
+ * @param run_data writes the data of the run that are not in the models
+ * @return false if the file cannot be written
+ */
+
+template<typename TIME>
+bool write_checkpoint(const checkpoint_registry<TIME> &registry,
+    const char *path, const TIME &now, uint64_t log_offset,
+    const std::function<void(checkpoint_writer&)> &run_data = nullptr){
+    const std::string temporary = std::string(path) + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if(!file){
+        printf("ERROR in opening file");
+        return false;
+    }
+    checkpoint_writer writer(file);
+    file << CHECKPOINT_MAGIC << ' ' << CHECKPOINT_VERSION << '\n';
+    writer.time(now);
+    writer.u64(log_offset);
+    writer.end_line();
+    if(run_data){
+        run_data(writer);
+    }
+    writer.end_line();
+    writer.u64(registry.models.size());
+    writer.end_line();
+    for(const auto &entry : registry.models){
+        writer.text(entry.first);
+        entry.second->save_state(writer);
+        writer.end_line();
+    }
+    file.close();
+    if(!file || rename(temporary.c_str(), path) != 0){
+        printf("ERROR in opening file");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Restores the models of a registry, which must be the same models (same
+ * ids, same order) as the run that wrote the checkpoint. The runner must
+ * then be built at now.
+ * @param registry models of the top model
+ * @param path checkpoint file
+ * @param now receives the time of the checkpoint
+ * @param log_offset receives the bytes of the log written up to now
+ * @param run_data reads what run_data of write_checkpoint wrote
+ * @return false if the file cannot be opened, a corrupt file or other
+ * models throw std::runtime_error
+ */
+
+template<typename TIME>
+bool read_checkpoint(checkpoint_registry<TIME> &registry, const char *path,
+    TIME &now, uint64_t &log_offset,
+    const std::function<void(checkpoint_reader&)> &run_data = nullptr){
+    std::ifstream file(path, std::ios::binary);
+    if(!file){
+        printf("ERROR in opening file");
+        return false;
+    }
+    checkpoint_reader reader(file);
+    std::string magic;
+    int version = 0;
+    reader.check(static_cast<bool>(file >> magic >> version) &&
+        magic == CHECKPOINT_MAGIC && version == CHECKPOINT_VERSION, "header");
+    now = reader.template time<TIME>();
+    log_offset = reader.u64();
+    if(run_data){
+        run_data(reader);
+    }
+    if(reader.u64() != registry.models.size()){
+        throw std::runtime_error("the checkpoint was taken with other models");
+    }
+    for(auto &entry : registry.models){
+        if(reader.text() != entry.first){
+            throw std::runtime_error("the checkpoint was taken with other models");
+        }
+        entry.second->load_state(reader, now);
+    }
+    return true;
+}
+
+/**
+ * Puts every model of a registry back to the state it was built with. The
+ * runner of the models must then be built again, or reset (see
+ * reusable_runner.hpp), before the next run.
+ * @param registry models of the top model
+ * @param seed_of gives the new seed of a model from its id
+ */
+
+template<typename TIME>
+void reset_models(checkpoint_registry<TIME> &registry,
+    const std::function<unsigned int(const std::string&)> &seed_of){
+    for(auto &entry : registry.models){
+        entry.second->reset_state(seed_of(entry.first));
+    }
+}
+
+#endif // _CHECKPOINT_HPP_
@@ -0,0 +1,151 @@
+/**
+ * \brief items waiting for their own delay inside an atomic model.
+ *
+ * A pipelined model (a Subnet with several packets on the wire, a sliding
+ * window Sender with one timer per packet) holds many items that leave at
+ * different times. The delay line keeps the clock of the model, advanced by
+ * the elapsed times of its transitions, and the items ordered by the time
+ * they leave; items that leave at the same time keep the order in which
+ * they were pushed.
+ */
+
+#ifndef _DELAY_LINE_HPP_
+#define _DELAY_LINE_HPP_
+
+#include <stdint.h>
+
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+template<typename TIME, typename T>
+class delay_line{
+    public:
+    /**<identifies an item that is still in the line*/
+    using ticket = std::pair<TIME, uint64_t>;
+
+    /**
+     * Adds an item that leaves after delay.
+     * @param delay time from now
+     * @param item
+     * @return ticket to erase the item before it leaves
+     */
+    ticket push(const TIME &delay, T item){
+        const ticket id(clock + delay, order++);
+        entries.emplace(id, std::move(item));
+        return id;
+    }
+
+    /**
+     * Removes an item before it leaves, e.g. the timer of an acknowledged
+     * packet.
+     * @param id ticket given by push
+     */
+    void erase(const ticket &id){
+        entries.erase(id);
+    }
+
+    /**
+     * Moves the clock of the model forward.
+     * @param elapsed time since the last transition
+     */
+    void advance(const TIME &elapsed){
+        clock = clock + elapsed;
+    }
+
+    /**
+     * @return time until the next item leaves, infinity if there is none
+     */
+    TIME next() const{
+        if(entries.empty()){
+            return std::numeric_limits<TIME>::infinity();
+        }
+        return entries.begin()->first.first - clock;
+    }
+
+    /**
+     * Calls f on every item that leaves at the next time, in push order.
+     * @param f callable taking const T&
+     */
+    template<typename F>
+    void for_each_due(F f) const{
+        for(auto it = entries.begin(); it != entries.end() &&
+            !(entries.begin()->first.first < it->first.first); ++it){
+            f(it->second);
+        }
+    }
+
+    /**
+     * Removes the items that leave at the next time, the clock must have
+     * been advanced up to it.
+     * @return the items removed, in push order
+     */
+    std::vector<T> pop_due(){
+        std::vector<T> due;
+        if(entries.empty()){
+            return due;
+        }
+        const TIME first = entries.begin()->first.first;
+        while(!entries.empty() && !(first < entries.begin()->first.first)){
+            due.push_back(std::move(entries.begin()->second));
+            entries.erase(entries.begin());
+        }
+        return due;
+    }
+
+    size_t size() const{
+        return entries.size();
+    }
+
+    bool empty() const{
+        return entries.empty();
+    }
+
+    void clear(){
+        entries.clear();
+    }
+
+    /**
+     * Writes the clock and the items to a checkpoint (see checkpoint.hpp).
+     * @param writer
+     * @param save_item writes one item, called as save_item(writer, item)
+     */
+    template<typename WRITER, typename F>
+    void save_checkpoint(WRITER &writer, F save_item) const{
+        writer.time(clock);
+        writer.u64(order);
+        writer.u64(entries.size());
+        for(const auto &entry : entries){
+            writer.time(entry.first.first);
+            writer.u64(entry.first.second);
+            save_item(writer, entry.second);
+        }
+    }
+
+    /**
+     * Replaces the clock and the items with the ones of a checkpoint, the
+     * tickets given before stay valid.
+     * @param reader
+     * @param load_item reads one item, called as load_item(reader, item)
+     */
+    template<typename READER, typename F>
+    void load_checkpoint(READER &reader, F load_item){
+        clock = reader.template time<TIME>();
+        order = reader.u64();
+        entries.clear();
+        for(uint64_t i = reader.u64(); i > 0; i--){
+            const TIME due = reader.template time<TIME>();
+            const uint64_t pushed = reader.u64();
+            load_item(reader, entries[ticket(due, pushed)]);
+        }
+    }
+
+    private:
+    TIME clock = TIME();
+    uint64_t order = 0;
+    /**<ordered by the time the item leaves, then by push order*/
+    std::map<ticket, T> entries;
+};
+
+#endif // _DELAY_LINE_HPP_
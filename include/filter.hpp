@@ -11,8 +11,20 @@
 #ifndef _FILTER_HPP_
 #define _FILTER_HPP_
 
+#include <stdio.h>
+
 char* trim(char* ip);
 
 void output_filter(const char *input,const char *output);
 
+void output_filter_mmap(const char *input,const char *output);
+
+void write_output_header(FILE *op);
+
+void write_output_row(FILE *op, const char *time, const char *port_value,
+    const char *port, const char *component);
+
+int format_output_row(char *row, size_t size, const char *time,
+    const char *port_value, const char *port, const char *component);
+
 #endif //_FILTER_HPP_
@@ -0,0 +1,392 @@
+/**
+ *\brief Go-Back-N sender and receiver models.
+ *
+ * Detailed Description : sliding window variants of Sender and Receiver.
+ * The sender keeps up to window_size packets on the wire instead of one, so
+ * it does not wait a whole round trip before preparing the next packet.
+ * It has one timer, for the oldest packet not acknowledged yet; when it
+ * expires every packet of the window is sent again. The receiver only
+ * accepts packets in order and acknowledges the last packet received in
+ * order (cumulative acknowledgement), out of order packets are dropped.
+ *
+ * Both models use the ports of sender_defs and receiver_defs, so they take
+ * the place of Sender and Receiver in the same Network and TOP couplings
+ * (see make_abp_link). As for Sender, ack_received_out gives one message
+ * per packet acknowledged (its sequence number) and packet_sent_out one
+ * message per packet sent, retransmissions included. The acknowledgements
+ * of the receiver are window_ack packets, logged as seq * 10 + bit.
+ */
+
+#ifndef __GBN_CADMIUM_HPP__
+#define __GBN_CADMIUM_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <limits>
+#include <assert.h>
+#include <string.h>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "message.hpp"
+#include "packet.hpp"
+#include "payload_pool.hpp"
+#include "delay_line.hpp"
+#include "sender_cadmium.hpp"
+#include "receiver_cadmium.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+/**
+ * Subtracts the elapsed time from a timer that may be off (infinity).
+ * @param timer time left
+ * @param elapsed
+ * @return time left after elapsed
+ */
+
+template<typename TIME>
+TIME window_timer_left(const TIME &timer, const TIME &elapsed){
+    if(timer == std::numeric_limits<TIME>::infinity()){
+        return timer;
+    }
+    return timer - elapsed;
+}
+
+/**
+ * Takes the payload of a new data packet from the pool, its first bytes
+ * hold the sequence number (as Sender does).
+ * @param seq sequence number of the packet
+ * @param length payload bytes, 0 for none
+ * @return the payload
+ */
+
+inline payload_handle window_payload(uint64_t seq, uint32_t length){
+    payload_handle payload;
+    if(length > 0){
+        payload = payload_pool::local().allocate(length);
+        memcpy(payload.data(), &seq, length < sizeof(seq) ? length : sizeof(seq));
+    }
+    return payload;
+}
+
+/**
+ * The class GbnSender sends the packets of a control message with a
+ * Go-Back-N window.
+ */
+
+template<typename TIME>
+class GbnSender{
+    /**< putting definitions in context*/
+    using defs=sender_defs;
+    public:
+    /**<time to prepare one new packet*/
+    TIME   PREPARATION_TIME;
+    /**<time waited for the acknowledgement of the oldest packet*/
+    TIME   timeout;
+    /**<packets sent and not acknowledged at most*/
+    uint32_t window_size;
+    /**<payload bytes of every data packet*/
+    uint32_t payload_length;
+
+    GbnSender() noexcept{
+        PREPARATION_TIME  = TIME("00:00:10");
+        timeout           = TIME("00:00:20");
+        window_size       = 1;
+        payload_length    = 0;
+        reset();
+    }
+
+    /**
+     * @param window_size packets on the wire at most (at least 1)
+     * @param payload_length payload bytes of every data packet
+     */
+    GbnSender(uint32_t window_size, uint32_t payload_length) noexcept
+        : GbnSender(){
+        this->window_size = window_size > 0 ? window_size : 1;
+        this->payload_length = payload_length;
+    }
+
+    /**
+     * @param window_size packets on the wire at most (at least 1)
+     * @param payload_length payload bytes of every data packet
+     * @param preparation_time time to prepare one new packet
+     * @param timeout time waited for the oldest acknowledgement
+     */
+    GbnSender(uint32_t window_size, uint32_t payload_length,
+        TIME preparation_time, TIME timeout) noexcept
+        : GbnSender(window_size, payload_length){
+        PREPARATION_TIME = preparation_time;
+        this->timeout = timeout;
+    }
+
+    /**
+     * Puts back the state of a new sender, the parameters are kept.
+     */
+    void reset() {
+        state = state_type();
+        state.base        = 1;
+        state.next_seq    = 1;
+        state.last_seq    = 0;
+        state.model_active = false;
+        state.send_in     = std::numeric_limits<TIME>::infinity();
+        state.timer       = std::numeric_limits<TIME>::infinity();
+    }
+
+    /**
+     * Packets base to next_seq - 1 are on the wire, their payloads are kept
+     * for a retransmission. next_seq is being prepared when send_in is not
+     * infinity.
+     */
+    struct state_type{
+        int64_t base;               /**<oldest packet not acknowledged*/
+        int64_t next_seq;           /**<next new packet*/
+        int64_t last_seq;           /**<last packet of the transfer*/
+        bool model_active;
+        TIME send_in;               /**<time until next_seq is ready*/
+        TIME timer;                 /**<time until the timeout of base*/
+        payload_handle preparing;   /**<payload of next_seq*/
+        std::deque<payload_handle> window;  /**<payloads of base..next_seq-1*/
+        std::vector<int64_t> acked; /**<packets to report on ack_received_out*/
+    };
+    state_type state;
+
+    using input_ports=std::tuple<typename defs::control_in, typename defs::ack_in>;
+    using output_ports=std::tuple<typename defs::packet_sent_out,
+        typename defs::ack_received_out, typename defs::data_out>;
+
+    /**
+     * Reports the acknowledged packets, or sends the packet prepared and,
+     * on a timeout, the whole window again.
+     */
+    void internal_transition() {
+        if (!state.acked.empty()){
+            state.acked.clear();
+            return;
+        }
+        const TIME elapsed = time_advance();
+        state.send_in = window_timer_left(state.send_in, elapsed);
+        state.timer = window_timer_left(state.timer, elapsed);
+        if (state.timer == TIME()){
+            state.timer = timeout;
+        }
+        if (state.send_in == TIME()){
+            state.window.push_back(std::move(state.preparing));
+            state.next_seq ++;
+            if (state.timer == std::numeric_limits<TIME>::infinity()){
+                state.timer = timeout;
+            }
+            state.send_in = std::numeric_limits<TIME>::infinity();
+            start_preparation();
+        }
+    }
+
+    /**
+     * A control message starts a transfer of that many more packets when
+     * the sender is passive. An acknowledgement of packet n acknowledges every
+     * packet up to n and slides the window.
+     * @param e time elapsed since the last transition
+     * @param mbs messages received
+     */
+    void external_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        state.send_in = window_timer_left(state.send_in, e);
+        state.timer = window_timer_left(state.timer, e);
+        for (const auto &x : get_messages<typename defs::control_in>(mbs)){
+            if (state.model_active == false){
+                const int64_t packets = static_cast<int64_t>(x.value);
+                if (packets > 0){
+                    // the numbering goes on from the previous transfer, so
+                    // the receiver does not take new packets for old ones
+                    state.last_seq = state.next_seq - 1 + packets;
+                    state.model_active = true;
+                    start_preparation();
+                }
+            }
+        }
+        for (const auto &x : get_messages<typename defs::ack_in>(mbs)){
+            const int64_t seq = static_cast<int64_t>(x.seq);
+            if (!state.model_active || seq < state.base || seq >= state.next_seq){
+                continue;
+            }
+            for (; state.base <= seq; state.base++){
+                state.acked.push_back(state.base);
+                state.window.pop_front();
+            }
+            state.timer = state.base == state.next_seq ?
+                std::numeric_limits<TIME>::infinity() : timeout;
+            start_preparation();
+            if (state.base > state.last_seq){
+                state.model_active = false;
+                state.timer = std::numeric_limits<TIME>::infinity();
+            }
+        }
+    }
+
+    void confluence_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+    }
+
+    typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+        message_t out;
+        if (!state.acked.empty()){
+            for (int64_t seq : state.acked){
+                out.value = seq;
+                get_messages<typename defs::ack_received_out>(bags).push_back(out);
+            }
+            return bags;
+        }
+        const TIME next = time_advance();
+        if (state.timer == next){
+            for (int64_t seq = state.base; seq < state.next_seq; seq++){
+                send(bags, seq, state.window[seq - state.base]);
+            }
+        }
+        if (state.send_in == next){
+            send(bags, state.next_seq, state.preparing);
+        }
+        return bags;
+    }
+
+    TIME time_advance() const {
+        if (!state.acked.empty()){
+            return TIME();
+        }
+        return state.timer < state.send_in ? state.timer : state.send_in;
+    }
+
+    friend std::ostringstream& operator<<(std::ostringstream& os,
+        const typename GbnSender<TIME>::state_type& i) {
+        os << "base: " << i.base << " & nextSeq: " << i.next_seq
+           << " & lastSeq: " << i.last_seq;
+        return os;
+    }
+
+    private:
+    /**
+     * Starts preparing next_seq when nothing is being prepared and the
+     * window has room for it.
+     */
+    void start_preparation() {
+        if (state.send_in == std::numeric_limits<TIME>::infinity() &&
+            state.next_seq <= state.last_seq &&
+            state.next_seq < state.base + static_cast<int64_t>(window_size)){
+            state.preparing = window_payload(state.next_seq, payload_length);
+            state.send_in = PREPARATION_TIME;
+        }
+    }
+
+    void send(typename make_message_bags<output_ports>::type &bags,
+        int64_t seq, const payload_handle &payload) const {
+        packet_t packet(packet_kind::data, seq, static_cast<uint8_t>(seq % 2),
+            payload_length);
+        packet.payload = payload;
+        get_messages<typename defs::data_out>(bags).push_back(std::move(packet));
+        message_t out;
+        out.value = seq;
+        get_messages<typename defs::packet_sent_out>(bags).push_back(out);
+    }
+};
+
+/**
+ * The class GbnReceiver accepts the packets in order and acknowledges the
+ * last one, PREPARATION_TIME after every packet received. Unlike Receiver
+ * it prepares several acknowledgements at once.
+ */
+
+template<typename TIME>
+class GbnReceiver{
+    /**< putting definitions in context*/
+    using defs=receiver_defs;
+    public:
+    /**<time between a packet and its acknowledgement*/
+    TIME   PREPARATION_TIME;
+
+    GbnReceiver() noexcept{
+        PREPARATION_TIME  = TIME("00:00:10");
+        reset();
+    }
+
+    /**
+     * @param preparation_time time between a packet and its acknowledgement
+     */
+    GbnReceiver(TIME preparation_time) noexcept : GbnReceiver(){
+        PREPARATION_TIME = preparation_time;
+    }
+
+    /**
+     * Puts back the state of a new receiver, PREPARATION_TIME is kept.
+     */
+    void reset() {
+        state = state_type();
+        state.expected    = 1;
+        state.bytes_received = 0;
+    }
+
+    struct state_type{
+        uint64_t expected;          /**<next packet accepted*/
+        uint64_t bytes_received;    /**<payload bytes of the packets accepted*/
+        delay_line<TIME, packet_t> acks;    /**<acknowledgements being prepared*/
+    };
+    state_type state;
+
+    using input_ports=std::tuple<typename defs::input>;
+    using output_ports=std::tuple<typename defs::output>;
+
+    void internal_transition() {
+        state.acks.advance(state.acks.next());
+        state.acks.pop_due();
+    }
+
+    /**
+     * Accepts the packets expected, drops the others (and their payload)
+     * and prepares the acknowledgement of the last packet accepted.
+     * @param e time elapsed since the last transition
+     * @param mbs packets received
+     */
+    void external_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        state.acks.advance(e);
+        for (const auto &x : get_messages<typename defs::input>(mbs)){
+            if (x.seq == state.expected){
+                state.bytes_received += x.payload.size();
+                state.expected ++;
+            }
+            const uint64_t last = state.expected - 1;
+            state.acks.push(PREPARATION_TIME,
+                packet_t(packet_kind::window_ack, last, static_cast<uint8_t>(last % 2)));
+        }
+    }
+
+    void confluence_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+    }
+
+    typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+        state.acks.for_each_due([&bags](const packet_t &ack){
+            get_messages<typename defs::output>(bags).push_back(ack);
+        });
+        return bags;
+    }
+
+    TIME time_advance() const {
+        return state.acks.next();
+    }
+
+    friend std::ostringstream& operator<<(std::ostringstream& os,
+        const typename GbnReceiver<TIME>::state_type& i) {
+        os << "ackNum: " << i.expected - 1 << " & bytesReceived: "
+           << i.bytes_received;
+        return os;
+    }
+};
+
+#endif // __GBN_CADMIUM_HPP__
@@ -0,0 +1,278 @@
+/**
+ * \brief counters and timers around the functions of atomic models.
+ *
+ * instrumented<MODEL>::model<TIME> derives from MODEL<TIME> and counts its
+ * internal, external and confluence transitions and its output() calls,
+ * the messages of the bags it emits, and the time spent in each function.
+ * Every instance registers its counters under its model id in a registry
+ * of the calling thread, and write_instrumentation_report() writes them as
+ * JSON once the runner returns from run_until.
+ *
+ * make_instrumented_atomic_model() takes the place of
+ * make_dynamic_atomic_model() in the builders. The instrumentation is only
+ * compiled with ABP_INSTRUMENTATION defined (make INSTRUMENT=1); without it
+ * instrumented<MODEL>::model is MODEL itself, make_instrumented_atomic_model
+ * forwards to make_dynamic_atomic_model and the report functions are empty,
+ * so the simulator is the same as without this header.
+ *
+ * The time is read with the time stamp counter on x86 (a few ns per read)
+ * and converted to ns with the steady clock over the whole run; other
+ * targets use the steady clock directly.
+ */
+
+#ifndef _INSTRUMENTED_MODEL_HPP_
+#define _INSTRUMENTED_MODEL_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+
+#ifdef ABP_INSTRUMENTATION
+
+#include <chrono>
+#include <tuple>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Clock of the instrumentation, in ticks.
+ */
+
+struct instrument_clock{
+    static uint64_t now(){
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+};
+
+/**
+ * Counters of one atomic model.
+ */
+
+struct model_counters{
+    std::string id;
+    uint64_t internal = 0;
+    uint64_t external = 0;
+    uint64_t confluence = 0;
+    uint64_t outputs = 0;           /**<output() calls*/
+    uint64_t empty_outputs = 0;     /**<output() calls with no message*/
+    uint64_t messages_out = 0;      /**<messages of all the bags emitted*/
+    uint64_t max_bag = 0;           /**<most messages emitted at once*/
+    uint64_t internal_ticks = 0;
+    uint64_t external_ticks = 0;
+    uint64_t confluence_ticks = 0;
+    uint64_t output_ticks = 0;
+};
+
+/**
+ * Counters of the models built on the calling thread, and the clock
+ * readings used to convert ticks to ns.
+ */
+
+struct instrumentation_registry{
+    std::vector<std::shared_ptr<model_counters>> models;
+    uint64_t first_tick = 0;
+    std::chrono::steady_clock::time_point first_time;
+
+    static instrumentation_registry& local(){
+        static thread_local instrumentation_registry registry;
+        return registry;
+    }
+
+    std::shared_ptr<model_counters> add(const std::string &id){
+        if(models.empty()){
+            first_tick = instrument_clock::now();
+            first_time = std::chrono::steady_clock::now();
+        }
+        models.push_back(std::make_shared<model_counters>());
+        models.back()->id = id;
+        return models.back();
+    }
+};
+
+/**
+ * @param bags output bags of a model
+ * @return number of messages in all the bags
+ */
+
+template<typename BAGS>
+uint64_t count_bag_messages(const BAGS &bags){
+    return std::apply([](const auto&... bag){
+        return (uint64_t(0) + ... + uint64_t(bag.messages.size()));
+    }, bags);
+}
+
+template<template<typename> class MODEL>
+struct instrumented{
+    template<typename TIME>
+    class model : public MODEL<TIME>{
+        using base = MODEL<TIME>;
+        public:
+        using typename base::input_ports;
+        using typename base::output_ports;
+
+        model() : model(std::string()){}
+
+        /**
+         * @param id model id, the key of the counters in the report
+         * @param args arguments of the constructor of MODEL
+         */
+        template<typename... Args>
+        explicit model(const std::string &id, Args&&... args)
+            : base(std::forward<Args>(args)...),
+              counters(instrumentation_registry::local().add(id)){}
+
+        void internal_transition(){
+            const uint64_t start = instrument_clock::now();
+            base::internal_transition();
+            counters->internal_ticks += instrument_clock::now() - start;
+            counters->internal++;
+        }
+
+        void external_transition(TIME e,
+            typename cadmium::make_message_bags<input_ports>::type mbs){
+            const uint64_t start = instrument_clock::now();
+            base::external_transition(e, std::move(mbs));
+            counters->external_ticks += instrument_clock::now() - start;
+            counters->external++;
+        }
+
+        void confluence_transition(TIME e,
+            typename cadmium::make_message_bags<input_ports>::type mbs){
+            const uint64_t start = instrument_clock::now();
+            base::confluence_transition(e, std::move(mbs));
+            counters->confluence_ticks += instrument_clock::now() - start;
+            counters->confluence++;
+        }
+
+        typename cadmium::make_message_bags<output_ports>::type output() const{
+            const uint64_t start = instrument_clock::now();
+            typename cadmium::make_message_bags<output_ports>::type bags =
+                base::output();
+            counters->output_ticks += instrument_clock::now() - start;
+            const uint64_t messages = count_bag_messages(bags);
+            counters->outputs++;
+            counters->messages_out += messages;
+            if(messages == 0){
+                counters->empty_outputs++;
+            }
+            if(messages > counters->max_bag){
+                counters->max_bag = messages;
+            }
+            return bags;
+        }
+
+        private:
+        std::shared_ptr<model_counters> counters;
+    };
+};
+
+/**
+ * Builds a dynamic atomic model whose functions are counted and timed.
+ * @param id model id
+ * @param args arguments of the constructor of ATOMIC
+ * @return the model
+ */
+
+template<template<typename> class ATOMIC, typename TIME, typename... Args>
+std::shared_ptr<cadmium::dynamic::modeling::model>
+make_instrumented_atomic_model(const std::string &id, Args&&... args){
+    return cadmium::dynamic::translate::make_dynamic_atomic_model<
+        instrumented<ATOMIC>::template model, TIME, std::string, Args...>(
+        id, std::string(id), std::forward<Args>(args)...);
+}
+
+/**
+ * Writes the counters of the models built on the calling thread as a JSON
+ * array, one object per model, times in ns.
+ * @param path file to write
+ * @return false if the file cannot be written
+ */
+
+inline bool write_instrumentation_report(const char *path){
+    instrumentation_registry &registry = instrumentation_registry::local();
+    const double ticks = static_cast<double>(instrument_clock::now() -
+        registry.first_tick);
+    const double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - registry.first_time).count());
+    const double ns_per_tick = ticks > 0 ? ns / ticks : 0;
+
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    fprintf(fp, "[\n");
+    for(size_t i = 0; i < registry.models.size(); i++){
+        const model_counters &c = *registry.models[i];
+        auto mean = [ns_per_tick](uint64_t total, uint64_t calls){
+            return calls > 0 ? total * ns_per_tick / calls : 0.0;
+        };
+        fprintf(fp, "  {\"model\": \"%s\", \"internal\": %llu, "
+            "\"external\": %llu, \"confluence\": %llu, \"output\": %llu, "
+            "\"empty_outputs\": %llu, \"messages_out\": %llu, "
+            "\"max_bag\": %llu, \"internal_ns\": %.0f, \"external_ns\": %.0f, "
+            "\"confluence_ns\": %.0f, \"output_ns\": %.0f, "
+            "\"internal_mean_ns\": %.1f, \"external_mean_ns\": %.1f, "
+            "\"confluence_mean_ns\": %.1f, \"output_mean_ns\": %.1f}%s\n",
+            c.id.c_str(), (unsigned long long)c.internal,
+            (unsigned long long)c.external, (unsigned long long)c.confluence,
+            (unsigned long long)c.outputs, (unsigned long long)c.empty_outputs,
+            (unsigned long long)c.messages_out, (unsigned long long)c.max_bag,
+            c.internal_ticks * ns_per_tick, c.external_ticks * ns_per_tick,
+            c.confluence_ticks * ns_per_tick, c.output_ticks * ns_per_tick,
+            mean(c.internal_ticks, c.internal), mean(c.external_ticks, c.external),
+            mean(c.confluence_ticks, c.confluence), mean(c.output_ticks, c.outputs),
+            i + 1 < registry.models.size() ? "," : "");
+    }
+    fprintf(fp, "]\n");
+    fclose(fp);
+    return true;
+}
+
+/**
+ * Forgets the models built on the calling thread, e.g. between two
+ * replications.
+ */
+
+inline void clear_instrumentation(){
+    instrumentation_registry::local().models.clear();
+}
+
+#else // ABP_INSTRUMENTATION
+
+template<template<typename> class MODEL>
+struct instrumented{
+    template<typename TIME>
+    using model = MODEL<TIME>;
+};
+
+template<template<typename> class ATOMIC, typename TIME, typename... Args>
+std::shared_ptr<cadmium::dynamic::modeling::model>
+make_instrumented_atomic_model(const std::string &id, Args&&... args){
+    return cadmium::dynamic::translate::make_dynamic_atomic_model<ATOMIC,
+        TIME, Args...>(id, std::forward<Args>(args)...);
+}
+
+inline bool write_instrumentation_report(const char *){
+    return true;
+}
+
+inline void clear_instrumentation(){}
+
+#endif // ABP_INSTRUMENTATION
+
+#endif // _INSTRUMENTED_MODEL_HPP_
@@ -21,7 +21,8 @@ struct compare{
 
 /**
  * this function is a variable function with variable number of parameters
- * which uses the concept of ellipsis
+ * which uses the concept of ellipsis. A row is kept when it matches any of
+ * the k compare structures.
  * @param input
  * @param output
  * @param k of type in :-number of arguments
@@ -0,0 +1,240 @@
+/**
+ * \brief logger that only writes the messages of chosen models and ports.
+ *
+ * logger_top writes one line per atomic model and per simulation step,
+ * mostly "[] generated by model ..." lines and time lines, and the output
+ * tables then keep a few ports of a few models. filtered_logger takes the
+ * models and the ports to keep as template arguments and replaces the
+ * multilogger of log_messages and global_time:
+ *
+ *   static constexpr char SENDERS[] = "sender";
+ *   using logger_top = filtered_logger<keep_models<SENDERS>,
+ *       keep_ports<sender_defs::packet_sent_out, sender_defs::ack_received_out>,
+ *       cadmium::dynamic::logger::formatter<TIME>, oss_sink_provider>;
+ *
+ * A message line is written only when its model is kept and at least one
+ * port kept has messages; the ports not kept and the empty ones are left
+ * out of the line. The time of the step is written once, before the first
+ * line kept at that time, and not at all for the steps that write nothing.
+ * Everything else is dropped after comparing the model id and scanning the
+ * bag, without calling the formatter or touching the sink, so the cost of
+ * the log and its size follow what is kept. The lines written have the
+ * format of logger_top, so output_filter, the streaming tables and the
+ * steady state monitor read them as before.
+ */
+
+#ifndef _LOG_FILTER_HPP_
+#define _LOG_FILTER_HPP_
+
+#include <stdlib.h>
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#include <cadmium/logger/common_loggers.hpp>
+
+/**
+ * Keeps every model.
+ */
+
+struct all_models{
+    static bool keeps(std::string_view){
+        return true;
+    }
+};
+
+/**
+ * Keeps the models named NAMES. A name that does not end with a digit also
+ * keeps the models of every link, "sender" keeps sender1, sender2, ...
+ */
+
+template<const char *... NAMES>
+struct keep_models{
+    static bool keeps(std::string_view id){
+        return (matches(id, NAMES) || ...);
+    }
+
+    private:
+    static bool matches(std::string_view id, std::string_view name){
+        if(id.substr(0, name.size()) != name){
+            return false;
+        }
+        if(id.size() == name.size()){
+            return true;
+        }
+        if(name.empty() || (name.back() >= '0' && name.back() <= '9')){
+            return false;
+        }
+        for(char c : id.substr(name.size())){
+            if(c < '0' || c > '9'){
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/**
+ * @return the name of a type as the message logger writes it, e.g.
+ * "sender_defs::packet_sent_out"
+ */
+
+template<typename T>
+std::string log_type_name(){
+    const char *name = typeid(T).name();
+#if defined(__GNUG__)
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if(status == 0 && demangled != nullptr){
+        std::string result(demangled);
+        free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+/**
+ * Keeps every port.
+ */
+
+struct all_ports{
+    static bool keeps(std::string_view){
+        return true;
+    }
+};
+
+/**
+ * Keeps the ports of the types PORTS.
+ */
+
+template<typename... PORTS>
+struct keep_ports{
+    static bool keeps(std::string_view port){
+        static const std::vector<std::string> names = {log_type_name<PORTS>()...};
+        for(const std::string &name : names){
+            if(port == name){
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * Selects the ports of a bag written by the message logger,
+ * "[port: {values}, port: {}]".
+ * @param bag bag of messages of one model
+ * @param kept receives the bag of the ports kept that have messages, when
+ * it is not the whole bag
+ * @return 0 if no port is kept, 1 if the whole bag is kept, 2 if the bag
+ * kept is in kept
+ */
+
+template<typename PORTS>
+int select_log_ports(std::string_view bag, std::string &kept){
+    if(bag.size() < 2 || bag.front() != '['){
+        return 0;
+    }
+    const size_t end = bag.size() - 1;
+    size_t position = 1;
+    int entries = 0;
+    int kept_entries = 0;
+    kept.clear();
+    while(position < end){
+        const size_t open = bag.find(": {", position);
+        if(open == std::string_view::npos || open > end){
+            break;
+        }
+        const size_t close = bag.find('}', open);
+        if(close == std::string_view::npos || close > end){
+            break;
+        }
+        entries++;
+        if(close > open + 3 && PORTS::keeps(bag.substr(position, open - position))){
+            kept += kept_entries == 0 ? "[" : ", ";
+            kept.append(bag.data() + position, close + 1 - position);
+            kept_entries++;
+        }
+        position = close + 1;
+        while(position < end && (bag[position] == ',' || bag[position] == ' ')){
+            position++;
+        }
+    }
+    if(kept_entries == 0){
+        return 0;
+    }
+    if(kept_entries == entries){
+        return 1;
+    }
+    kept += "]";
+    return 2;
+}
+
+template<typename MODELS, typename PORTS, typename FORMATTER, typename SINK>
+struct filtered_logger{
+    template<typename DECLARED_SOURCE, typename INFO, typename... PARAMs>
+    static void log(const PARAMs&... params){
+        if constexpr(std::is_same<DECLARED_SOURCE,
+            cadmium::logger::logger_messages>::value){
+            log_bag(params...);
+        }
+        // the time is written with the first message kept at that time
+    }
+
+    private:
+    using time_logger = cadmium::logger::logger<
+        cadmium::logger::logger_global_time, FORMATTER, SINK>;
+    using message_logger = cadmium::logger::logger<
+        cadmium::logger::logger_messages, FORMATTER, SINK>;
+
+    /**
+     * Last time written on the calling thread.
+     */
+    template<typename TIME>
+    struct written_time{
+        TIME time;
+        bool written = false;
+    };
+
+    template<typename TIME>
+    static written_time<TIME>& last_time(){
+        static thread_local written_time<TIME> last;
+        return last;
+    }
+
+    template<typename TIME, typename ID, typename BAG>
+    static void log_bag(const TIME &t, const ID &id, const BAG &bag){
+        if(!MODELS::keeps(std::string_view(id))){
+            return;
+        }
+        static thread_local std::string kept;
+        const int selected = select_log_ports<PORTS>(std::string_view(bag), kept);
+        if(selected == 0){
+            return;
+        }
+        written_time<TIME> &last = last_time<TIME>();
+        if(!last.written || !(last.time == t)){
+            time_logger::template log<cadmium::logger::logger_global_time,
+                cadmium::logger::run_global_time>(t);
+            last.time = t;
+            last.written = true;
+        }
+        if(selected == 1){
+            message_logger::template log<cadmium::logger::logger_messages,
+                cadmium::logger::sim_messages_collect>(t, id, bag);
+        }else{
+            message_logger::template log<cadmium::logger::logger_messages,
+                cadmium::logger::sim_messages_collect>(t, id, kept);
+        }
+    }
+};
+
+#endif // _LOG_FILTER_HPP_
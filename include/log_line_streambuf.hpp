@@ -0,0 +1,73 @@
+/**
+ * \brief stream buffer that hands the logger output over line by line.
+ *
+ * The cadmium loggers only know a std::ostream given by the sink provider.
+ * Giving them a std::ostream built on a class derived from log_line_streambuf
+ * lets that class see every log line as soon as it is written, instead of
+ * reading the log back from a file once the simulation is over.
+ */
+
+#ifndef _LOG_LINE_STREAMBUF_HPP_
+#define _LOG_LINE_STREAMBUF_HPP_
+
+#include <cstring>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+class log_line_streambuf : public std::streambuf{
+    public:
+    virtual ~log_line_streambuf() = default;
+
+    /**
+     * Hands over the last line if it was not ended by '\n'.
+     */
+    void flush_lines(){
+        if(!pending.empty()){
+            on_line(pending);
+            pending.clear();
+        }
+    }
+
+    protected:
+    /**
+     * Called for every complete line, without its '\n'. The text is only
+     * valid during the call.
+     * @param line the log line
+     */
+    virtual void on_line(std::string_view line) = 0;
+
+    int_type overflow(int_type c) override{
+        if(c != traits_type::eof()){
+            char character = traits_type::to_char_type(c);
+            xsputn(&character, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override{
+        const char *end = s + n;
+        while(s < end){
+            const char *new_line = static_cast<const char*>(
+                std::memchr(s, '\n', end - s));
+            if(new_line == nullptr){
+                pending.append(s, end - s);
+                break;
+            }
+            if(pending.empty()){
+                on_line(std::string_view(s, new_line - s));
+            }else{
+                pending.append(s, new_line - s);
+                on_line(pending);
+                pending.clear();
+            }
+            s = new_line + 1;
+        }
+        return n;
+    }
+
+    private:
+    std::string pending;
+};
+
+#endif // _LOG_LINE_STREAMBUF_HPP_
@@ -0,0 +1,161 @@
+/**
+ * \brief helpers to read the text written by the cadmium message logger.
+ *
+ * The logger_top multilogger writes two kinds of lines:
+ *
+ *   00:00:20:000
+ *   [sender_defs::packet_sent_out: {1}, sender_defs::data_out: {11}] generated by model sender1
+ *
+ * The first one is the global time, the second one is the bag of messages
+ * produced by one model at that time. The functions in this header split
+ * those lines without copying them, so they can be used both on whole log
+ * files and on lines captured while the simulation runs.
+ */
+
+#ifndef _LOG_PARSER_HPP_
+#define _LOG_PARSER_HPP_
+
+#include <string_view>
+
+/**<text between the bag of messages and the model name*/
+static constexpr std::string_view GENERATED_BY_MODEL = "] generated by model ";
+
+/**
+ * Checks whether a log line is a global time line, i.e. "hh:mm:ss:mmm".
+ * @param line log line without the end of line
+ * @return true if the line only holds a time stamp
+ */
+
+inline bool is_time_line(std::string_view line){
+    if(line.empty() || line[0] < '0' || line[0] > '9'){
+        return false;
+    }
+    for(char c : line){
+        if((c < '0' || c > '9') && c != ':' && c != ' ' && c != '\t' && c != '\r'){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Removes the trailing spaces, tabs and end of line characters.
+ * @param text text to trim
+ * @return the trimmed text
+ */
+
+inline std::string_view trim_right(std::string_view text){
+    while(!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+        text.back() == '\n' || text.back() == '\r')){
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/**
+ * Converts a time written as "hh:mm:ss:mmm" (any number of fields, the
+ * last one in milliseconds when there are four) to milliseconds.
+ * @param text time stamp
+ * @return time in milliseconds
+ */
+
+inline long long log_time_to_milliseconds(std::string_view text){
+    long long fields[4] = {0, 0, 0, 0};
+    int count = 0;
+    long long current = 0;
+    for(char c : text){
+        if(c >= '0' && c <= '9'){
+            current = current * 10 + (c - '0');
+        }else if(c == ':'){
+            if(count < 4){
+                fields[count] = current;
+            }
+            count++;
+            current = 0;
+        }
+    }
+    if(count < 4){
+        fields[count] = current;
+    }
+    count++;
+    long long milliseconds = ((fields[0] * 60 + fields[1]) * 60 + fields[2]) * 1000;
+    if(count >= 4){
+        milliseconds += fields[3];
+    }
+    return milliseconds;
+}
+
+/**
+ * Converts a time written as "hh:mm:ss:mmm" to seconds.
+ * @param text time stamp
+ * @return time in seconds
+ */
+
+inline double log_time_to_seconds(std::string_view text){
+    return log_time_to_milliseconds(text) / 1000.0;
+}
+
+/**
+ * Gives the short name of a port, e.g. "sender_defs::data_out" gives
+ * "data_out" and "iestream_input_defs<message_t>::out" gives "out".
+ * @param port full port type name as printed by the logger
+ * @return the text after the last "::"
+ */
+
+inline std::string_view short_port_name(std::string_view port){
+    size_t position = port.rfind("::");
+    if(position == std::string_view::npos){
+        return port;
+    }
+    return port.substr(position + 2);
+}
+
+/**
+ * Splits a message line into the model that generated it and its
+ * non empty port values. The callback is called as f(port, value) for
+ * every port that carries at least one message, with the short port name
+ * and the text between the braces (e.g. "11" or "1, 2").
+ * @param line one message line of the log
+ * @param model receives the name of the model that generated the bag
+ * @param f callback for every non empty port
+ * @return false if the line is not a message line
+ */
+
+template<typename FUNCTION>
+bool for_each_port_value(std::string_view line, std::string_view &model,
+    FUNCTION f){
+
+    line = trim_right(line);
+    if(line.empty() || line[0] != '['){
+        return false;
+    }
+    size_t end_of_bag = line.rfind(GENERATED_BY_MODEL);
+    if(end_of_bag == std::string_view::npos){
+        return false;
+    }
+    model = line.substr(end_of_bag + GENERATED_BY_MODEL.size());
+
+    size_t position = 1;
+    while(position < end_of_bag){
+        size_t open = line.find(": {", position);
+        if(open == std::string_view::npos || open > end_of_bag){
+            break;
+        }
+        size_t close = line.find('}', open);
+        if(close == std::string_view::npos || close > end_of_bag){
+            break;
+        }
+        std::string_view value = line.substr(open + 3, close - open - 3);
+        if(!value.empty()){
+            f(short_port_name(line.substr(position, open - position)), value);
+        }
+        position = close + 1;
+        while(position < end_of_bag &&
+            (line[position] == ',' || line[position] == ' ')){
+            position++;
+        }
+    }
+    return true;
+}
+
+#endif // _LOG_PARSER_HPP_
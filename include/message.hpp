@@ -2,21 +2,28 @@
 #define BOOST_SIMULATION_MESSAGE_HPP
 
 #include <assert.h>
+#include <stdint.h>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 using namespace std;
 
 /*******************************************/
 /**************** message_t ****************/
 /*******************************************/
+/**
+ * The control messages, the packet numbers sent and the acknowledgements
+ * received are counts and sequence numbers, so the value is an integer:
+ * a float would print 1000000 as "1e+06" and lose packets past 2^24.
+ */
 struct message_t{
 
   message_t(){}
-  message_t(float i_value)
+  message_t(int64_t i_value)
    :value(i_value){}
 
-  	float   value;
+  	int64_t value = 0;
 
   void clear() {
    message_t();
@@ -27,5 +34,14 @@ istream& operator>> (istream& is, message_t& msg);
 
 ostream& operator<<(ostream& os, const message_t& msg);
 
+/**
+ * Reads a message of an input file without a stream, used by the event
+ * loader of iestream_input.
+ * @param text the message field of a line
+ * @param msg receives the message
+ * @return false if the field is not an integer
+ */
+bool parse_input_value(std::string_view text, message_t& msg);
+
 
 #endif // BOOST_SIMULATION_MESSAGE_HPP
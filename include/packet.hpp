@@ -0,0 +1,189 @@
+/**
+ * \brief packet header carried between Sender, Subnet and Receiver.
+ *
+ * message_t used to hold one float, so the sender sent
+ * packetNum * 10 + alt_bit and the receiver recovered the bit with % 10,
+ * which is only exact up to about 2^24 packets. packet_t keeps the fields
+ * apart, with a 64 bit sequence number.
+ *
+ * The text form is the number the float message used to carry,
+ * seq * 10 + bit for a data packet and bit for an acknowledgement, so the
+ * logs, output.txt and the binary traces are unchanged. The acknowledgements
+ * of the window protocols (window_ack) name the packet they acknowledge and
+ * are written seq * 10 + bit, as the data packets. The binary form is
+ * PACKET_BINARY_SIZE bytes in the byte order of the host, it holds the
+ * header only.
+ *
+ * A data packet can carry a payload of length bytes from payload_pool.hpp;
+ * copying the packet only copies the handle of the payload.
+ */
+
+#ifndef _PACKET_HPP_
+#define _PACKET_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+#include "payload_pool.hpp"
+
+enum class packet_kind : uint8_t {
+    data = 0,   /**<packet sent by the sender*/
+    ack = 1,    /**<acknowledgement sent by the receiver*/
+    window_ack = 2  /**<acknowledgement of a window protocol receiver, of seq*/
+};
+
+/**<size of a packet in its binary form*/
+static constexpr size_t PACKET_BINARY_SIZE = 14;
+
+struct packet_t{
+    uint64_t seq = 0;                       /**<sequence number, from 1*/
+    uint32_t length = 0;                    /**<payload length in bytes*/
+    uint8_t bit = 0;                        /**<alternating bit*/
+    packet_kind kind = packet_kind::data;
+    payload_handle payload;                 /**<bytes of a data packet, can be empty*/
+
+    packet_t() = default;
+    packet_t(packet_kind kind, uint64_t seq, uint8_t bit, uint32_t length = 0)
+        : seq(seq), length(length), bit(bit), kind(kind){}
+
+    /**
+     * @return the number a float message_t used to carry for this packet,
+     * seq * 10 + bit for a window_ack
+     */
+    uint64_t legacy_value() const{
+        return kind == packet_kind::ack ? bit : seq * 10 + bit;
+    }
+
+    /**
+     * Builds a data packet from the number of a float message_t, as found
+     * in the input files of the tests.
+     * @param value seq * 10 + bit
+     * @return the packet
+     */
+    static packet_t from_legacy_value(uint64_t value){
+        return packet_t(packet_kind::data, value / 10,
+            static_cast<uint8_t>(value % 10));
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const packet_t& packet){
+    char text[24];
+    std::to_chars_result written = std::to_chars(text, text + sizeof(text),
+        packet.legacy_value());
+    os.write(text, written.ptr - text);
+    return os;
+}
+
+inline std::istream& operator>>(std::istream& is, packet_t& packet){
+    uint64_t value;
+    if(is >> value){
+        packet = packet_t::from_legacy_value(value);
+    }
+    return is;
+}
+
+/**
+ * Reads a packet of an input file without a stream, used by the event
+ * loader of iestream_input.
+ * @param text the message field of a line
+ * @param packet receives the packet
+ * @return false if the field is not a number
+ */
+
+inline bool parse_input_value(std::string_view text, packet_t& packet){
+    uint64_t value;
+    std::from_chars_result parsed = std::from_chars(text.data(),
+        text.data() + text.size(), value);
+    if(parsed.ec != std::errc()){
+        return false;
+    }
+    packet = packet_t::from_legacy_value(value);
+    return true;
+}
+
+/**
+ * Writes a packet in its binary form.
+ * @param os
+ * @param packet
+ */
+
+inline void write_packet(std::ostream& os, const packet_t& packet){
+    char record[PACKET_BINARY_SIZE];
+    memcpy(record, &packet.seq, 8);
+    memcpy(record + 8, &packet.length, 4);
+    record[12] = static_cast<char>(packet.bit);
+    record[13] = static_cast<char>(packet.kind);
+    os.write(record, sizeof(record));
+}
+
+/**
+ * Reads a packet written by write_packet.
+ * @param is
+ * @param packet
+ * @return false at the end of the stream
+ */
+
+inline bool read_packet(std::istream& is, packet_t& packet){
+    char record[PACKET_BINARY_SIZE];
+    if(!is.read(record, sizeof(record))){
+        return false;
+    }
+    memcpy(&packet.seq, record, 8);
+    memcpy(&packet.length, record + 8, 4);
+    packet.bit = static_cast<uint8_t>(record[12]);
+    packet.kind = static_cast<packet_kind>(record[13]);
+    return true;
+}
+
+/**
+ * Writes a packet to a checkpoint (see checkpoint.hpp). Of the payload only
+ * its size and its first 8 bytes, the sequence number written by the
+ * senders, are kept; the rest of the bytes is never read.
+ * @param writer
+ * @param packet
+ */
+
+template<typename WRITER>
+void save_packet_checkpoint(WRITER &writer, const packet_t &packet){
+    writer.u64(packet.seq);
+    writer.u64(packet.length);
+    writer.u64(packet.bit);
+    writer.u64(static_cast<uint64_t>(packet.kind));
+    writer.u64(packet.payload.size());
+    if(packet.payload.size() > 0){
+        uint64_t header = 0;
+        memcpy(&header, packet.payload.data(),
+            packet.payload.size() < sizeof(header) ? packet.payload.size() :
+            sizeof(header));
+        writer.u64(header);
+    }
+}
+
+/**
+ * Reads a packet written by save_packet_checkpoint, with a new payload
+ * from the pool of the calling thread.
+ * @param reader
+ * @param packet
+ */
+
+template<typename READER>
+void load_packet_checkpoint(READER &reader, packet_t &packet){
+    packet.seq = reader.u64();
+    packet.length = static_cast<uint32_t>(reader.u64());
+    packet.bit = static_cast<uint8_t>(reader.u64());
+    packet.kind = static_cast<packet_kind>(reader.u64());
+    const size_t size = static_cast<size_t>(reader.u64());
+    packet.payload.reset();
+    if(size > 0){
+        const uint64_t header = reader.u64();
+        packet.payload = payload_pool::local().allocate(size);
+        memcpy(packet.payload.data(), &header,
+            size < sizeof(header) ? size : sizeof(header));
+    }
+}
+
+#endif // _PACKET_HPP_
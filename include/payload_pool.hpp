@@ -0,0 +1,249 @@
+/**
+ * \brief pool of payload buffers carried by the data packets.
+ *
+ * A payload is a block of bytes with a reference count, handed around
+ * through payload_handle: copying a packet copies the handle, not the bytes,
+ * so a Subnet forwards a payload without copying it, and a retransmission
+ * sends the same block again. When the last handle goes away the block goes
+ * back to the free list of its size class, so steady state transfers do not
+ * call malloc.
+ *
+ * Blocks are taken from slabs of about PAYLOAD_SLAB_BYTES, cut in blocks of
+ * a power of two size between PAYLOAD_MIN_BLOCK and PAYLOAD_MAX_BLOCK bytes.
+ * Larger payloads are allocated alone. The counters tell how many requests
+ * were served from a free list (hits) and how many needed new memory
+ * (misses).
+ *
+ * Every thread has its own pool (payload_pool::local()) and the reference
+ * counts are not atomic, so a payload must not be shared between threads,
+ * which is the case since every simulation runs in one thread.
+ */
+
+#ifndef _PAYLOAD_POOL_HPP_
+#define _PAYLOAD_POOL_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+/**<smallest block size*/
+static constexpr size_t PAYLOAD_MIN_BLOCK = 64;
+/**<largest pooled block size, larger payloads are allocated alone*/
+static constexpr size_t PAYLOAD_MAX_BLOCK = 1 << 20;
+/**<number of size classes from PAYLOAD_MIN_BLOCK to PAYLOAD_MAX_BLOCK*/
+static constexpr size_t PAYLOAD_CLASSES = 15;
+/**<memory taken at once for the blocks of one size class*/
+static constexpr size_t PAYLOAD_SLAB_BYTES = 1 << 20;
+
+class payload_pool;
+
+/**
+ * Header placed before the bytes of every payload.
+ */
+
+struct payload_block{
+    payload_pool *pool;
+    uint32_t refs;
+    uint32_t size_class;    /**<PAYLOAD_CLASSES for a block allocated alone*/
+    uint32_t size;          /**<bytes in use*/
+    uint32_t reserved;
+};
+
+/**
+ * Reference counted handle to a payload.
+ */
+
+class payload_handle{
+    public:
+    payload_handle() = default;
+
+    payload_handle(const payload_handle &other) noexcept : block(other.block){
+        if(block != nullptr){
+            block->refs++;
+        }
+    }
+
+    payload_handle(payload_handle &&other) noexcept : block(other.block){
+        other.block = nullptr;
+    }
+
+    payload_handle& operator=(const payload_handle &other) noexcept{
+        if(other.block != nullptr){
+            other.block->refs++;
+        }
+        reset();
+        block = other.block;
+        return *this;
+    }
+
+    payload_handle& operator=(payload_handle &&other) noexcept{
+        if(this != &other){
+            reset();
+            block = other.block;
+            other.block = nullptr;
+        }
+        return *this;
+    }
+
+    ~payload_handle(){
+        reset();
+    }
+
+    /**
+     * Drops this reference, the block goes back to its pool with the last
+     * one.
+     */
+    inline void reset() noexcept;
+
+    explicit operator bool() const noexcept{
+        return block != nullptr;
+    }
+
+    size_t size() const noexcept{
+        return block == nullptr ? 0 : block->size;
+    }
+
+    char* data() const noexcept{
+        return block == nullptr ? nullptr : reinterpret_cast<char*>(block + 1);
+    }
+
+    uint32_t use_count() const noexcept{
+        return block == nullptr ? 0 : block->refs;
+    }
+
+    private:
+    friend class payload_pool;
+    explicit payload_handle(payload_block *block) noexcept : block(block){}
+
+    payload_block *block = nullptr;
+};
+
+class payload_pool{
+    public:
+    /**
+     * Counters of the pool.
+     */
+    struct counters{
+        uint64_t hits = 0;          /**<requests served from a free list*/
+        uint64_t misses = 0;        /**<requests that needed new memory*/
+        uint64_t in_use = 0;        /**<blocks referenced by a handle*/
+        uint64_t peak_in_use = 0;
+        uint64_t bytes_reserved = 0; /**<memory taken from the system*/
+    };
+
+    payload_pool() = default;
+    payload_pool(const payload_pool&) = delete;
+    payload_pool& operator=(const payload_pool&) = delete;
+
+    ~payload_pool(){
+        // handles that outlive the pool keep their memory
+        if(stats.in_use != 0){
+            for(std::unique_ptr<char[]> &slab : slabs){
+                slab.release();
+            }
+        }
+    }
+
+    /**
+     * @return the pool of the calling thread
+     */
+    static payload_pool& local(){
+        static thread_local payload_pool pool;
+        return pool;
+    }
+
+    /**
+     * Gives a payload of size bytes. The bytes are not initialized.
+     * @param size
+     * @return handle with one reference
+     */
+    payload_handle allocate(size_t size){
+        const size_t size_class = class_of(size);
+        payload_block *block;
+        if(size_class == PAYLOAD_CLASSES){
+            block = static_cast<payload_block*>(
+                malloc(sizeof(payload_block) + size));
+            stats.misses++;
+            stats.bytes_reserved += sizeof(payload_block) + size;
+        }else{
+            std::vector<payload_block*> &free_list = free_lists[size_class];
+            if(free_list.empty()){
+                grow(size_class);
+                stats.misses++;
+            }else{
+                stats.hits++;
+            }
+            block = free_list.back();
+            free_list.pop_back();
+        }
+        block->pool = this;
+        block->refs = 1;
+        block->size_class = static_cast<uint32_t>(size_class);
+        block->size = static_cast<uint32_t>(size);
+        stats.in_use++;
+        if(stats.in_use > stats.peak_in_use){
+            stats.peak_in_use = stats.in_use;
+        }
+        return payload_handle(block);
+    }
+
+    const counters& statistics() const{
+        return stats;
+    }
+
+    private:
+    friend class payload_handle;
+
+    static size_t class_of(size_t size){
+        size_t size_class = 0;
+        size_t block_size = PAYLOAD_MIN_BLOCK;
+        while(block_size < size && size_class < PAYLOAD_CLASSES){
+            block_size <<= 1;
+            size_class++;
+        }
+        return size_class;
+    }
+
+    /**
+     * Cuts a new slab into blocks of one size class.
+     * @param size_class
+     */
+    void grow(size_t size_class){
+        const size_t block_bytes = sizeof(payload_block) +
+            (PAYLOAD_MIN_BLOCK << size_class);
+        const size_t blocks = block_bytes < PAYLOAD_SLAB_BYTES ?
+            PAYLOAD_SLAB_BYTES / block_bytes : 1;
+        slabs.emplace_back(new char[blocks * block_bytes]);
+        stats.bytes_reserved += blocks * block_bytes;
+        char *slab = slabs.back().get();
+        for(size_t i = blocks; i > 0; i--){
+            free_lists[size_class].push_back(
+                reinterpret_cast<payload_block*>(slab + (i - 1) * block_bytes));
+        }
+    }
+
+    void release(payload_block *block){
+        stats.in_use--;
+        if(block->size_class == PAYLOAD_CLASSES){
+            stats.bytes_reserved -= sizeof(payload_block) + block->size;
+            free(block);
+        }else{
+            free_lists[block->size_class].push_back(block);
+        }
+    }
+
+    std::vector<payload_block*> free_lists[PAYLOAD_CLASSES];
+    std::vector<std::unique_ptr<char[]>> slabs;
+    counters stats;
+};
+
+inline void payload_handle::reset() noexcept{
+    if(block != nullptr && --block->refs == 0){
+        block->pool->release(block);
+    }
+    block = nullptr;
+}
+
+#endif // _PAYLOAD_POOL_HPP_
@@ -0,0 +1,117 @@
+/**
+ * \brief query engine on the output table (output.txt).
+ *
+ * The raw log of the message logger (abp_output.txt) can be queried as
+ * well: its bags are read as the rows output_filter would write, one per
+ * non empty port, and the matching rows are written in the table format.
+ *
+ * A query group is a list of predicates and the file where the matching
+ * rows of the table are written. A row matches a group when it matches at
+ * least one of its predicates, and it matches a predicate when all the
+ * fields given in the predicate match:
+ *
+ *   component   name of the model that generated the message
+ *   port        short name of the port
+ *   time        range of simulation times, in seconds or hh:mm:ss:mmm
+ *   value       range of values
+ *
+ * All the groups are evaluated in a single pass over the table, and the
+ * component/port test is only done once for every distinct pair.
+ *
+ * Text form of a group, used by the query tool: predicates separated by
+ * '|', fields of a predicate separated by ';', for example
+ *
+ *   component=sender1;port=ack_received_out;time=00:01:00:000..00:05:00:000
+ *   component=subnet1;value=10..20|component=subnet2;value=10..20
+ */
+
+#ifndef _QUERY_HPP_
+#define _QUERY_HPP_
+
+#include <stdio.h>
+
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * One condition on the rows of the table. Empty names and infinite bounds
+ * match everything.
+ */
+
+struct query_predicate{
+    std::string component;
+    std::string port;
+    double time_min = -std::numeric_limits<double>::infinity();
+    double time_max = std::numeric_limits<double>::infinity();
+    double value_min = -std::numeric_limits<double>::infinity();
+    double value_max = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * Predicates whose matching rows go to the same output file.
+ */
+
+struct query_group{
+    std::vector<query_predicate> predicates;
+    std::string output;
+    long matches = 0;   /**<number of rows written, set by run_queries*/
+};
+
+/**
+ * Reads a group written in its text form.
+ * @param text predicates of the group
+ * @param output path of the file for the matching rows
+ * @return the group
+ */
+
+query_group parse_query_group(const std::string &text, const std::string &output);
+
+/**
+ * One row of the table split in its columns.
+ */
+
+struct query_row{
+    std::string_view time;
+    std::string_view value;
+    std::string_view port;
+    std::string_view component;
+};
+
+/**
+ * Splits a row: the first column is the time, the last two are the port
+ * and the component, and the value is what is between them (it can hold
+ * spaces when a bag has several messages).
+ * @param line row, with or without its end of line
+ * @param row receives the columns
+ * @return false for a line that is not a row
+ */
+
+bool split_query_row(std::string_view line, query_row &row);
+
+/**
+ * Tells whether a file is a raw log of the message logger rather than an
+ * output table, from its first line (a time line or a bag). The file is
+ * read again from its start afterwards.
+ * @param fp open file
+ * @return true for a raw log
+ */
+
+bool is_raw_log(FILE *fp);
+
+/**
+ * Writes the matching rows of every group in its own file, reading the
+ * table (or the raw log) only once. When the table has an up to date index (see
+ * trace_index.hpp), only the blocks that can hold matching rows are read.
+ * Every file starts with the table headings and, as limit_output does,
+ * ends with a message when no row matched.
+ * @param input path of the output table or of the raw log
+ * @param groups groups to evaluate, their matches are updated
+ * @return number of rows read (only the rows of the selected blocks when
+ * an index is used)
+ */
+
+long run_queries(const char *input, std::vector<query_group> &groups);
+
+#endif // _QUERY_HPP_
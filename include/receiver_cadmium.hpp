@@ -31,6 +31,8 @@
 #include <random>
 
 #include "message.hpp"
+#include "packet.hpp"
+#include "checkpoint.hpp"
 
 using namespace cadmium;
 using namespace std;
@@ -40,9 +42,9 @@ using namespace std;
  */
  
 struct receiver_defs{
-    struct output : public out_port<message_t> {
+    struct output : public out_port<packet_t> {
     };
-    struct input : public in_port<message_t> {
+    struct input : public in_port<packet_t> {
     };
 };
    
@@ -67,18 +69,37 @@ class Receiver{
      
     Receiver() noexcept{
         PREPARATION_TIME  = TIME("00:00:10");
-        state.ack_num    = 0;
+        reset();
+    }
+
+    /**
+     * Constructor with the time between a packet and its acknowledgement.
+     * @param preparation_time
+     */
+
+    Receiver(TIME preparation_time) noexcept : Receiver(){
+        PREPARATION_TIME = preparation_time;
+    }
+
+    /**
+     * Puts back the state of a new receiver, PREPARATION_TIME is kept.
+     */
+
+    void reset() {
+        state.packet      = packet_t();
         state.sending     = false;
+        state.bytes_received = 0;
     }
             
     /**
-     * In the structure below it has the acknowledgment number and state
+     * In the structure below it has the last packet received and state
      * of the receiver
      */
      
     struct state_type{
-        int ack_num;
+        packet_t packet;
         bool sending;
+        uint64_t bytes_received;   /**<payload bytes of distinct packets*/
     };
     state_type state;
 
@@ -110,7 +131,12 @@ class Receiver{
                 assert(false && "one message per time uniti");
             }
             for(const auto &x : get_messages<typename defs::input>(mbs)){
-                state.ack_num = static_cast < int > (x.value);
+                if (x.seq != state.packet.seq) {
+                    state.bytes_received += x.payload.size();
+                }
+                state.packet = x;
+                // the payload is consumed, its block goes back to the pool
+                state.packet.payload.reset();
                 state.sending = true;
             }
                            
@@ -131,16 +157,15 @@ class Receiver{
 
     /**
      * This function sends acknowledgment to the output port
-     * The acknowledgment value is calculated by the modulo of
-     * acknowledgment number with 10.
+     * The acknowledgment carries the sequence number and the alternating
+     * bit of the packet received.
      * @return variable bags of type make_message_bags
      */
 
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
-        message_t out;
-        out.value = state.ack_num % 10;
-        get_messages<typename defs::output>(bags).push_back(out);
+        get_messages<typename defs::output>(bags).emplace_back(
+            packet_kind::ack, state.packet.seq, state.packet.bit);
         return bags;
     }
 
@@ -162,13 +187,35 @@ class Receiver{
     }
     
     /**
-     * Function returns acknowledgment number to a string stream
-     * @return string stream which is acknowledgment number
+     * Writes the state to a checkpoint.
+     * @param writer
+     */
+
+    void save_checkpoint(checkpoint_writer &writer) const {
+        save_packet_checkpoint(writer, state.packet);
+        writer.boolean(state.sending);
+        writer.u64(state.bytes_received);
+    }
+
+    /**
+     * Reads the state written by save_checkpoint.
+     * @param reader
+     */
+
+    void load_checkpoint(checkpoint_reader &reader) {
+        load_packet_checkpoint(reader, state.packet);
+        state.sending = reader.boolean();
+        state.bytes_received = reader.u64();
+    }
+
+    /**
+     * Function returns the last packet received to a string stream
+     * @return string stream which is the last packet received
      */
      
     friend std::ostringstream& operator<<(std::ostringstream& os,
     const typename Receiver<TIME>::state_type& i) {
-        os << "ackNum: " << i.ack_num;
+        os << "ackNum: " << i.packet << " & bytesReceived: " << i.bytes_received;
         return os;
     }
 };
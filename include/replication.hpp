@@ -0,0 +1,257 @@
+/**
+ * \brief Monte Carlo replications of the ABP top model.
+ *
+ * Each replication is one independent run of the TOP model with its own
+ * seed. The message log of a replication is kept in memory (one log per
+ * worker thread) and summarized as soon as the run ends, so no file is
+ * written while the replications run. The summaries of all replications
+ * are then combined into means with 95% confidence intervals.
+ */
+
+#ifndef _REPLICATION_HPP_
+#define _REPLICATION_HPP_
+
+#include <atomic>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "log_parser.hpp"
+
+/**
+ * In memory log of the replication that runs on the calling thread.
+ * @return the log stream of this thread
+ */
+
+inline std::ostringstream& replication_log(){
+    thread_local std::ostringstream log;
+    return log;
+}
+
+/**
+ * Sink provider for the cadmium loggers that writes in the in memory log of
+ * the current thread, so every worker logs its own replication.
+ */
+
+struct replication_sink_provider{
+    static std::ostream& sink(){
+        return replication_log();
+    }
+};
+
+/**
+ * This structure stores the measures taken from one replication.
+ */
+
+struct replication_result{
+    unsigned int seed = 0;
+    long packets_sent = 0;       /**<packet_sent_out messages, retransmissions included*/
+    long acks_received = 0;      /**<ack_received_out messages*/
+    long retransmissions = 0;    /**<packets sent again after a timeout*/
+    double completion_time = 0;  /**<time of the last ack in seconds*/
+    double throughput = 0;       /**<acknowledged packets per second*/
+};
+
+/**
+ * This structure stores the mean of a measure over all the replications
+ * with the half width of its 95% confidence interval.
+ */
+
+struct interval_estimate{
+    double mean = 0;
+    double std_dev = 0;
+    double half_width = 0;
+};
+
+/**
+ * Reads the message log of one run and computes its measures. Packets are
+ * counted on packet_sent_out and acks on ack_received_out, for all senders
+ * of the run, every message of a bag on its own.
+ * @param log message log written by logger_top
+ * @return the measures of the run
+ */
+
+inline replication_result summarize_replication(std::istream &log){
+    replication_result result;
+    std::set<std::pair<std::string, std::string>> distinct_packets;
+    std::string line;
+    double time = 0;
+
+    while(std::getline(log, line)){
+        std::string_view view(line);
+        if(is_time_line(view)){
+            time = log_time_to_seconds(view);
+            continue;
+        }
+        std::string_view model;
+        for_each_port_value(view, model,
+            [&](std::string_view port, std::string_view values){
+                if(port != "packet_sent_out" && port != "ack_received_out"){
+                    return;
+                }
+                // a bag with several messages is written as "v1, v2"
+                while(!values.empty()){
+                    const size_t comma = values.find(',');
+                    std::string_view value = values.substr(0, comma);
+                    values = comma == std::string_view::npos ?
+                        std::string_view() : values.substr(comma + 1);
+                    while(!value.empty() && value.front() == ' '){
+                        value.remove_prefix(1);
+                    }
+                    if(port == "packet_sent_out"){
+                        result.packets_sent++;
+                        distinct_packets.emplace(std::string(model),
+                            std::string(value));
+                    }else{
+                        result.acks_received++;
+                        result.completion_time = time;
+                    }
+                }
+            });
+    }
+    result.retransmissions = result.packets_sent -
+        static_cast<long>(distinct_packets.size());
+    if(result.completion_time > 0){
+        result.throughput = result.acks_received / result.completion_time;
+    }
+    return result;
+}
+
+/**
+ * Two sided 97.5% quantile of the Student t distribution, used for 95%
+ * confidence intervals.
+ * @param degrees degrees of freedom
+ * @return the quantile
+ */
+
+inline double student_t_975(int degrees){
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if(degrees < 1){
+        return 0;
+    }
+    if(degrees <= 30){
+        return table[degrees - 1];
+    }
+    if(degrees <= 60){
+        return 2.000;
+    }
+    if(degrees <= 120){
+        return 1.980;
+    }
+    return 1.960;
+}
+
+/**
+ * Computes the mean and the 95% confidence interval of a list of samples.
+ * @param samples one value per replication
+ * @return the estimate
+ */
+
+inline interval_estimate estimate_interval(const std::vector<double> &samples){
+    interval_estimate estimate;
+    const size_t n = samples.size();
+    if(n == 0){
+        return estimate;
+    }
+    double sum = 0;
+    for(double x : samples){
+        sum += x;
+    }
+    estimate.mean = sum / n;
+    if(n > 1){
+        double squares = 0;
+        for(double x : samples){
+            squares += (x - estimate.mean) * (x - estimate.mean);
+        }
+        estimate.std_dev = std::sqrt(squares / (n - 1));
+        estimate.half_width = student_t_975(static_cast<int>(n - 1)) *
+            estimate.std_dev / std::sqrt(static_cast<double>(n));
+    }
+    return estimate;
+}
+
+/**
+ * Runs count replications on a pool of threads. Every thread takes the
+ * next replication number until all of them are done, and writes its
+ * result in its own slot, so no lock is needed.
+ * @param count number of replications
+ * @param threads number of worker threads (0 means one per core)
+ * @param run_one function called as run_one(replication number) that
+ *        returns the result of that replication, a replication_result or
+ *        any other default constructible type
+ * @return the results in replication order
+ */
+
+template<typename FUNCTION,
+    typename RESULT = std::invoke_result_t<FUNCTION&, int>>
+std::vector<RESULT> run_replications(int count, unsigned int threads,
+    FUNCTION run_one){
+
+    std::vector<RESULT> results(count > 0 ? count : 0);
+    if(threads == 0){
+        threads = std::thread::hardware_concurrency();
+    }
+    if(threads == 0){
+        threads = 1;
+    }
+    if(count > 0 && threads > static_cast<unsigned int>(count)){
+        threads = count;
+    }
+
+    std::atomic<int> next{0};
+    std::vector<std::thread> workers;
+    for(unsigned int i = 0; i < threads; i++){
+        workers.emplace_back([&](){
+            for(int replication = next++; replication < count;
+                replication = next++){
+                results[replication] = run_one(replication);
+            }
+        });
+    }
+    for(auto &worker : workers){
+        worker.join();
+    }
+    return results;
+}
+
+/**
+ * Writes the confidence intervals of throughput, retransmissions and
+ * completion time over all the replications.
+ * @param os output stream
+ * @param results results of the replications
+ */
+
+inline void print_replication_summary(std::ostream &os,
+    const std::vector<replication_result> &results){
+
+    std::vector<double> throughput, retransmissions, completion_time;
+    for(const auto &r : results){
+        throughput.push_back(r.throughput);
+        retransmissions.push_back(static_cast<double>(r.retransmissions));
+        completion_time.push_back(r.completion_time);
+    }
+    const std::pair<const char*, interval_estimate> rows[] = {
+        {"throughput (packets/s)", estimate_interval(throughput)},
+        {"retransmissions", estimate_interval(retransmissions)},
+        {"completion time (s)", estimate_interval(completion_time)}
+    };
+    os << "Replications: " << results.size() << std::endl;
+    for(const auto &row : rows){
+        os << row.first << ": " << row.second.mean << " +/- "
+           << row.second.half_width << " (95% CI, std dev "
+           << row.second.std_dev << ")" << std::endl;
+    }
+}
+
+#endif // _REPLICATION_HPP_
@@ -0,0 +1,73 @@
+/**
+ * \brief runner that keeps its top model between runs.
+ *
+ * The runner of cadmium builds its coordinators and simulators over the
+ * top model and initializes them once, at the time it is built. A
+ * reusable_runner keeps the top model and rebuilds only that engine when
+ * it is reset, so a run after reset_abp_top (abp_topology.hpp) starts from
+ * the same state as a run of a new top model, without building the models
+ * or the couplings again:
+ *
+ *   auto models = std::make_shared<checkpoint_registry<TIME>>();
+ *   reusable_runner<TIME, logger_top> r(make_abp_top<TIME>(input, 1, 1,
+ *       channel_config(), 0, protocol_config(), models), {0});
+ *   r.run_until(end);
+ *   reset_abp_top<TIME>(*models, 2);
+ *   r.reset({0});
+ *   r.run_until(end);
+ */
+
+#ifndef _REUSABLE_RUNNER_HPP_
+#define _REUSABLE_RUNNER_HPP_
+
+#include <memory>
+#include <utility>
+
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+
+template<typename TIME, typename LOGGER>
+class reusable_runner{
+    public:
+    /**
+     * @param top top model, kept until the runner is destroyed
+     * @param init_time time of the first run
+     */
+    reusable_runner(std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> top,
+        const TIME &init_time) : top(std::move(top)){
+        reset(init_time);
+    }
+
+    /**
+     * Runs the events before t, as the runner of cadmium does.
+     * @param t end of the run
+     * @return the time of the next event
+     */
+    TIME run_until(const TIME &t){
+        return engine->run_until(t);
+    }
+
+    /**
+     * Starts the engine again at init_time. The models are not touched, they
+     * must have been reset before (reset_models of checkpoint.hpp).
+     * @param init_time time of the next run
+     */
+    void reset(const TIME &init_time){
+        engine.reset();
+        engine = std::make_unique<cadmium::dynamic::engine::runner<TIME,
+            LOGGER>>(top, init_time);
+    }
+
+    /**
+     * @return the top model
+     */
+    const std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>>& model() const{
+        return top;
+    }
+
+    private:
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> top;
+    std::unique_ptr<cadmium::dynamic::engine::runner<TIME, LOGGER>> engine;
+};
+
+#endif // _REUSABLE_RUNNER_HPP_
@@ -0,0 +1,145 @@
+/**
+ * \brief adaptive retransmission timeout of the Sender.
+ *
+ * rto_estimator follows Jacobson/Karels (RFC 6298): every round trip
+ * sample R updates the smoothed round trip time and its mean deviation
+ *
+ *   RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|
+ *   SRTT   = 7/8 SRTT + 1/8 R
+ *   RTO    = SRTT + max(G, 4 RTTVAR)
+ *
+ * and every timeout doubles the RTO until a new sample arrives. The Sender
+ * only takes samples of packets sent once (Karn's rule), since the
+ * acknowledgement of a packet sent again cannot be matched to one copy.
+ *
+ * sender_statistics collects what the senders did, so runs with the fixed
+ * and the adaptive timer can be compared. All the times are in seconds.
+ */
+
+#ifndef _RTO_ESTIMATOR_HPP_
+#define _RTO_ESTIMATOR_HPP_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+/**<clock granularity G*/
+static constexpr double RTO_GRANULARITY = 0.001;
+/**<lowest timeout*/
+static constexpr double RTO_MIN = 1;
+/**<highest timeout, also the cap of the backoff*/
+static constexpr double RTO_MAX = 240;
+
+struct rto_estimator{
+    double srtt = 0;
+    double rttvar = 0;
+    double rto = 20;            /**<timeout until the first sample*/
+    bool has_sample = false;
+
+    rto_estimator() = default;
+    explicit rto_estimator(double initial_rto) : rto(initial_rto){}
+
+    /**
+     * Takes the round trip time of a packet sent once.
+     * @param rtt seconds from the packet to its acknowledgement
+     */
+    void sample(double rtt){
+        if(!has_sample){
+            srtt = rtt;
+            rttvar = rtt / 2;
+            has_sample = true;
+        }else{
+            rttvar = 0.75 * rttvar + 0.25 * std::fabs(srtt - rtt);
+            srtt = 0.875 * srtt + 0.125 * rtt;
+        }
+        rto = srtt + std::fmax(RTO_GRANULARITY, 4 * rttvar);
+        clamp();
+    }
+
+    /**
+     * Doubles the timeout after it expired.
+     */
+    void backoff(){
+        rto *= 2;
+        clamp();
+    }
+
+    private:
+    void clamp(){
+        rto = std::fmin(std::fmax(rto, RTO_MIN), RTO_MAX);
+    }
+};
+
+/**
+ * What the senders of a run did. One object can be shared by the senders
+ * of every link of a run, which all run on the same thread.
+ */
+
+struct sender_statistics{
+    uint64_t transmissions = 0;     /**<packets sent, retransmissions included*/
+    uint64_t retransmissions = 0;   /**<packets sent again after a timeout*/
+    uint64_t timeouts = 0;
+    uint64_t rtt_samples = 0;       /**<round trips measured (Karn's rule)*/
+    double rtt_sum = 0;
+    double rto_sum = 0;             /**<sum of the timeouts armed*/
+    uint64_t rto_armed = 0;
+    std::vector<double> completion_times;   /**<control message to last ack*/
+
+    /**
+     * Writes a summary of the statistics.
+     * @param os
+     */
+    void print(std::ostream &os) const{
+        double completion_sum = 0;
+        for(double time : completion_times){
+            completion_sum += time;
+        }
+        os << "Transmissions: " << transmissions
+           << ", retransmissions: " << retransmissions
+           << ", timeouts: " << timeouts << std::endl;
+        os << "Mean RTT: " << (rtt_samples > 0 ? rtt_sum / rtt_samples : 0)
+           << "s over " << rtt_samples << " samples, mean timeout: "
+           << (rto_armed > 0 ? rto_sum / rto_armed : 0) << "s" << std::endl;
+        os << "Transfers completed: " << completion_times.size()
+           << ", mean completion time: " << (completion_times.empty() ? 0 :
+           completion_sum / completion_times.size()) << "s" << std::endl;
+    }
+
+    /**
+     * Writes the statistics to a checkpoint (see checkpoint.hpp).
+     * @param writer
+     */
+    template<typename WRITER>
+    void save_checkpoint(WRITER &writer) const{
+        writer.u64(transmissions);
+        writer.u64(retransmissions);
+        writer.u64(timeouts);
+        writer.u64(rtt_samples);
+        writer.f64(rtt_sum);
+        writer.f64(rto_sum);
+        writer.u64(rto_armed);
+        writer.u64(completion_times.size());
+        for(double time : completion_times){
+            writer.f64(time);
+        }
+    }
+
+    template<typename READER>
+    void load_checkpoint(READER &reader){
+        transmissions = reader.u64();
+        retransmissions = reader.u64();
+        timeouts = reader.u64();
+        rtt_samples = reader.u64();
+        rtt_sum = reader.f64();
+        rto_sum = reader.f64();
+        rto_armed = reader.u64();
+        completion_times.resize(reader.u64());
+        for(double &time : completion_times){
+            time = reader.f64();
+        }
+    }
+};
+
+#endif // _RTO_ESTIMATOR_HPP_
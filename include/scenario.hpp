@@ -0,0 +1,195 @@
+/**
+ * \brief scenario files of the batch mode.
+ *
+ * A scenario file holds one run of the top model per line, as key=value
+ * fields separated by spaces. A field that is not given keeps the value of
+ * the simulator, and '#' starts a comment:
+ *
+ *   # nightly sweep
+ *   name=base input=../data/input_abp_0.txt seed=1 horizon=04:00:00
+ *   name=lossy input=../data/input_abp_0.txt seed=1 loss=bernoulli:0.2
+ *   name=sr8 input=../data/input_abp_1.txt protocol=sr:8 timeout=40 links=4
+ *
+ * Fields:
+ *   name=TEXT                   name of the results row (line number)
+ *   input=PATH                  control input file (required, must exist)
+ *   seed=N                      seed of the subnets (0)
+ *   links=N                     Sender/Receiver/Network links (1)
+ *   horizon=HH:MM:SS[:mmm]|inf  end of the run (04:00:00:000)
+ *   delay=MODEL loss=MODEL      channel of the subnets, see channel_model.hpp
+ *   protocol=abp|gbn:W|sr:W     see abp_topology.hpp (abp)
+ *   rto=fixed|adaptive          timer of the abp senders (fixed)
+ *   payload=BYTES               payload of every data packet (0)
+ *   preparation=S               PREPARATION_TIME of the senders (10)
+ *   timeout=S                   timeout of the senders (20)
+ *   receiver_preparation=S      PREPARATION_TIME of the receivers (10)
+ */
+
+#ifndef _SCENARIO_HPP_
+#define _SCENARIO_HPP_
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "abp_topology.hpp"
+#include "channel_model.hpp"
+#include "log_parser.hpp"
+
+/**
+ * Parameters of one run of the batch mode.
+ */
+
+struct scenario{
+    std::string name;
+    std::string input;
+    unsigned int seed = 0;
+    int links = 1;
+    std::string horizon = "04:00:00:000";   /**<as given, for the results*/
+    double horizon_seconds = 4 * 3600;      /**<infinity for inf*/
+    channel_config channel;
+    protocol_config protocol;
+    uint32_t payload_length = 0;
+};
+
+/**
+ * Reads the horizon of a scenario.
+ * @param value "inf" or HH:MM:SS[:mmm]
+ * @return the horizon in seconds, infinity for "inf"
+ */
+
+inline double parse_horizon(const std::string &value){
+    if(value == "inf"){
+        return std::numeric_limits<double>::infinity();
+    }
+    int fields = 1;
+    bool digits = false;
+    for(char c : value){
+        if(c >= '0' && c <= '9'){
+            digits = true;
+        }else if(c == ':' && digits){
+            fields++;
+            digits = false;
+        }else{
+            throw std::invalid_argument("wrong horizon " + value);
+        }
+    }
+    if(!digits || fields < 3 || fields > 4){
+        throw std::invalid_argument("wrong horizon " + value);
+    }
+    return log_time_to_milliseconds(value) / 1000.0;
+}
+
+/**
+ * Reads one line of a scenario file.
+ * @param line text of the line, without comment
+ * @param number line number, the default name of the scenario
+ * @return the scenario, fields that are not given keep their default
+ */
+
+inline scenario parse_scenario(const std::string &line, int number){
+    scenario s;
+    s.name = std::to_string(number);
+    // protocol= gives a new protocol_config, so the timer and the times are
+    // kept apart and applied once the whole line is read
+    bool adaptive_timeout = false;
+    const protocol_config defaults;
+    double preparation = defaults.sender_preparation;
+    double timeout = defaults.timeout;
+    double receiver_preparation = defaults.receiver_preparation;
+    std::istringstream fields(line);
+    std::string field;
+    while(fields >> field){
+        const size_t equal = field.find('=');
+        if(equal == std::string::npos){
+            throw std::invalid_argument("field without value " + field);
+        }
+        const std::string key = field.substr(0, equal);
+        const std::string value = field.substr(equal + 1);
+        if(key == "name"){
+            s.name = value;
+        }else if(key == "input"){
+            s.input = value;
+        }else if(key == "seed"){
+            s.seed = std::stoul(value);
+        }else if(key == "links"){
+            s.links = std::stoi(value);
+        }else if(key == "horizon"){
+            s.horizon = value;
+            s.horizon_seconds = parse_horizon(value);
+        }else if(key == "delay"){
+            s.channel.delay = value;
+        }else if(key == "loss"){
+            s.channel.loss = value;
+        }else if(key == "protocol"){
+            s.protocol = parse_protocol(value);
+        }else if(key == "rto"){
+            if(value != "fixed" && value != "adaptive"){
+                throw std::invalid_argument("unknown rto " + value);
+            }
+            adaptive_timeout = value == "adaptive";
+        }else if(key == "payload"){
+            s.payload_length = std::stoul(value);
+        }else if(key == "preparation"){
+            preparation = std::stod(value);
+        }else if(key == "timeout"){
+            timeout = std::stod(value);
+        }else if(key == "receiver_preparation"){
+            receiver_preparation = std::stod(value);
+        }else{
+            throw std::invalid_argument("unknown field " + key);
+        }
+    }
+    s.protocol.adaptive_timeout = adaptive_timeout;
+    s.protocol.sender_preparation = preparation;
+    s.protocol.timeout = timeout;
+    s.protocol.receiver_preparation = receiver_preparation;
+    if(s.input.empty()){
+        throw std::invalid_argument("missing input");
+    }
+    if(!std::ifstream(s.input)){
+        throw std::invalid_argument("cannot open input " + s.input);
+    }
+    if(s.links < 1){
+        throw std::invalid_argument("the number of links should be at least 1");
+    }
+    // the channel models are built once here, so a wrong model is reported
+    // before any run starts
+    channel_model check(s.channel);
+    return s;
+}
+
+/**
+ * Reads every scenario of a scenario file.
+ * @param path scenario file
+ * @return the scenarios in file order
+ */
+
+inline std::vector<scenario> read_scenarios(const char *path){
+    std::ifstream file(path);
+    if(!file){
+        throw std::invalid_argument(std::string("cannot open scenarios ") + path);
+    }
+    std::vector<scenario> scenarios;
+    std::string line;
+    int number = 0;
+    while(std::getline(file, line)){
+        number++;
+        line = line.substr(0, line.find('#'));
+        if(line.find_first_not_of(" \t\r") == std::string::npos){
+            continue;
+        }
+        try{
+            scenarios.push_back(parse_scenario(line, number));
+        }catch(const std::exception &e){
+            throw std::invalid_argument("line " + std::to_string(number) +
+                " of " + path + ": " + e.what());
+        }
+    }
+    return scenarios;
+}
+
+#endif // _SCENARIO_HPP_
@@ -11,6 +11,7 @@
 #include <limits>
 #include <math.h> 
 #include <assert.h>
+#include <string.h>
 #include <memory>
 #include <iomanip>
 #include <iostream>
@@ -22,6 +23,11 @@
 #include <random>
 
 #include "message.hpp"
+#include "packet.hpp"
+#include "payload_pool.hpp"
+#include "rto_estimator.hpp"
+#include "time_conversion.hpp"
+#include "checkpoint.hpp"
 
 using namespace cadmium;
 using namespace std;
@@ -32,11 +38,11 @@ using namespace std;
         };
         struct ack_received_out : public out_port<message_t> {
         };
-        struct data_out : public out_port<message_t> {
+        struct data_out : public out_port<packet_t> {
         };
         struct control_in : public in_port<message_t> {
         };
-        struct ack_in : public in_port<message_t> {
+        struct ack_in : public in_port<packet_t> {
         };
     };
 
@@ -47,24 +53,84 @@ using namespace std;
             //Parameters to be overwriten when instantiating the atomic model
             TIME   PREPARATION_TIME;
             TIME   timeout;
+            uint32_t payload_length;
+            // timeout computed from the round trip times instead of timeout
+            bool adaptive_timeout;
+            // transmissions, timeouts and completion times, can be shared
+            std::shared_ptr<sender_statistics> statistics;
+            // timeout in seconds, set by reset() so the transitions do not
+            // convert it
+            double timeout_seconds;
             // default constructor
             Sender() noexcept{
               PREPARATION_TIME  = TIME("00:00:10");
               timeout          = TIME("00:00:20");
+              payload_length   = 0;
+              adaptive_timeout = false;
+              reset();
+            }
+
+            // constructor with the size of the payload of every data packet
+            Sender(uint32_t payload_length) noexcept : Sender(){
+              this->payload_length = payload_length;
+            }
+
+            // constructor with the timer mode and the statistics to fill
+            // (nullptr for none)
+            Sender(uint32_t payload_length, bool adaptive_timeout,
+              std::shared_ptr<sender_statistics> statistics) noexcept
+              : Sender(payload_length){
+              this->adaptive_timeout = adaptive_timeout;
+              this->statistics = std::move(statistics);
+            }
+
+            // constructor that also sets the preparation time and the
+            // fixed timeout, which is the first adaptive timeout as well
+            Sender(uint32_t payload_length, bool adaptive_timeout,
+              std::shared_ptr<sender_statistics> statistics,
+              TIME preparation_time, TIME timeout) noexcept
+              : Sender(payload_length, adaptive_timeout, std::move(statistics)){
+              PREPARATION_TIME = preparation_time;
+              this->timeout = timeout;
+              reset();
+            }
+
+            // puts back the state of a new sender, the parameters are kept
+            // and the statistics are left to their owner
+            void reset() {
+              state = state_type();
+              state.ack        = false;
+              state.packetNum  = 0;
+              state.totalPacketNum = 0;
+              state.sending    = false;
               state.alt_bit    = 0;
               state.next_internal    = std::numeric_limits<TIME>::infinity();
               state.model_active     = false;
+              state.retransmitted    = false;
+              state.clock            = TIME("00:00:00");
+              state.sent_at          = TIME("00:00:00");
+              state.transfer_start   = TIME("00:00:00");
+              timeout_seconds = time_to_seconds(timeout);
+              state.rto = rto_estimator(timeout_seconds);
+              rto_changed();
             }
             
             // state definition
             struct state_type{
               bool ack;
-              int packetNum;
-              int totalPacketNum;
+              int64_t packetNum;
+              int64_t totalPacketNum;
+              payload_handle payload;   // payload of packetNum until it is acknowledged
               int alt_bit;
               bool sending;
               bool model_active;
               TIME next_internal;
+              TIME clock;               // time since the start of the run
+              TIME sent_at;             // last copy of packetNum sent
+              TIME transfer_start;      // control message of the transfer
+              bool retransmitted;       // packetNum was sent more than once
+              rto_estimator rto;        // used when adaptive_timeout is set
+              TIME rto_timeout;         // rto.rto as a TIME
             }; 
             state_type state;
             // ports definition
@@ -73,15 +139,22 @@ using namespace std;
 
             // internal transition
             void internal_transition() {
+              state.clock = state.clock + state.next_internal;
               if (state.ack){
                 if (state.packetNum < state.totalPacketNum){
                   state.packetNum ++;
+                  new_payload();
+                  state.retransmitted = false;
                   state.ack = false;
                   state.alt_bit = (state.alt_bit + 1) % 2;
                   state.sending = true;
                   state.model_active = true; 
                   state.next_internal = PREPARATION_TIME;
                 } else {
+                  if (statistics && state.model_active){
+                    statistics->completion_times.push_back(
+                      time_to_seconds(state.clock - state.transfer_start));
+                  }
                   state.model_active = false;
                   state.next_internal = std::numeric_limits<TIME>::infinity();
                 }
@@ -89,8 +162,24 @@ using namespace std;
                 if (state.sending){
                   state.sending = false;
                   state.model_active = true;
-                  state.next_internal = timeout;
+                  state.sent_at = state.clock;
+                  state.next_internal = current_timeout();
+                  if (statistics){
+                    statistics->transmissions ++;
+                    statistics->retransmissions += state.retransmitted ? 1 : 0;
+                    statistics->rto_sum += current_timeout_seconds();
+                    statistics->rto_armed ++;
+                  }
                 } else {
+                  // the timeout expired, packetNum is prepared again
+                  state.retransmitted = true;
+                  if (adaptive_timeout){
+                    state.rto.backoff();
+                    rto_changed();
+                  }
+                  if (statistics){
+                    statistics->timeouts ++;
+                  }
                   state.sending = true;
                   state.model_active = true;
                   state.next_internal = PREPARATION_TIME;
@@ -98,14 +187,40 @@ using namespace std;
               }   
             }
 
+            // timeout armed after a packet is sent
+            TIME current_timeout() const {
+              if (adaptive_timeout){
+                return state.rto_timeout;
+              }
+              return timeout;
+            }
+
+            // current_timeout() in seconds, rounded to the millisecond as
+            // the TIME is
+            double current_timeout_seconds() const {
+              if (adaptive_timeout){
+                return std::llround(state.rto.rto * 1000) / 1000.0;
+              }
+              return timeout_seconds;
+            }
+
+            // builds the TIME of the timeout again once rto.rto changed
+            void rto_changed() {
+              state.rto_timeout = seconds_to_time<TIME>(state.rto.rto);
+            }
+
             // external transition
             void external_transition(TIME e, typename make_message_bags<input_ports>::type mbs) { 
               if((get_messages<typename defs::control_in>(mbs).size()+get_messages<typename defs::ack_in>(mbs).size())>1) assert(false && "one message per time uniti");
+              state.clock = state.clock + e;
               for(const auto &x : get_messages<typename defs::control_in>(mbs)){
                 if(state.model_active == false){
-                  state.totalPacketNum = static_cast < int > (x.value);
+                  state.totalPacketNum = static_cast < int64_t > (x.value);
                   if (state.totalPacketNum > 0){
                     state.packetNum = 1;
+                    state.transfer_start = state.clock;
+                    state.retransmitted = false;
+                    new_payload();
                     state.ack = false;
                     state.sending = true;
                     state.alt_bit = state.packetNum % 2;  //set initial alt_bit
@@ -120,8 +235,22 @@ using namespace std;
               }
               for(const auto &x : get_messages<typename defs::ack_in>(mbs)){
                 if(state.model_active == true) { 
-                  if (state.alt_bit == static_cast < int > (x.value)) {
+                  if (state.alt_bit == x.bit) {
+                    // Karn's rule: only the round trips of packets sent once
+                    if (!state.sending && !state.retransmitted &&
+                      (adaptive_timeout || statistics)){
+                      const double rtt = time_to_seconds(state.clock - state.sent_at);
+                      if (adaptive_timeout){
+                        state.rto.sample(rtt);
+                        rto_changed();
+                      }
+                      if (statistics){
+                        statistics->rtt_samples ++;
+                        statistics->rtt_sum += rtt;
+                      }
+                    }
                     state.ack = true;
+                    state.payload.reset();
                     state.sending = false;
                     state.next_internal = TIME("00:00:00");
                   }else{
@@ -145,8 +274,10 @@ using namespace std;
               typename make_message_bags<output_ports>::type bags;
               message_t out;
               if (state.sending){
-                out.value = state.packetNum * 10 + state.alt_bit;
-                get_messages<typename defs::data_out>(bags).push_back(out);
+                packet_t packet(packet_kind::data, state.packetNum, state.alt_bit,
+                  payload_length);
+                packet.payload = state.payload;
+                get_messages<typename defs::data_out>(bags).push_back(std::move(packet));
                 out.value = state.packetNum;
                 get_messages<typename defs::packet_sent_out>(bags).push_back(out);
               }else{
@@ -159,11 +290,67 @@ using namespace std;
 
             }
 
+            // takes the payload of a new packet from the pool, its first
+            // bytes hold the sequence number
+            void new_payload() {
+              if (payload_length > 0){
+                state.payload = payload_pool::local().allocate(payload_length);
+                const uint64_t seq = static_cast<uint64_t>(state.packetNum);
+                memcpy(state.payload.data(), &seq,
+                  payload_length < sizeof(seq) ? payload_length : sizeof(seq));
+              }
+            }
+
             // time_advance function
             TIME time_advance() const {  
               return state.next_internal;
             }
 
+            // writes the state to a checkpoint, the payload is taken again
+            // from the pool when it is read back
+            void save_checkpoint(checkpoint_writer &writer) const {
+              writer.boolean(state.ack);
+              writer.i64(state.packetNum);
+              writer.i64(state.totalPacketNum);
+              writer.boolean(static_cast<bool>(state.payload));
+              writer.i64(state.alt_bit);
+              writer.boolean(state.sending);
+              writer.boolean(state.model_active);
+              writer.time(state.next_internal);
+              writer.time(state.clock);
+              writer.time(state.sent_at);
+              writer.time(state.transfer_start);
+              writer.boolean(state.retransmitted);
+              writer.f64(state.rto.srtt);
+              writer.f64(state.rto.rttvar);
+              writer.f64(state.rto.rto);
+              writer.boolean(state.rto.has_sample);
+            }
+
+            void load_checkpoint(checkpoint_reader &reader) {
+              state.ack = reader.boolean();
+              state.packetNum = reader.i64();
+              state.totalPacketNum = reader.i64();
+              const bool has_payload = reader.boolean();
+              state.alt_bit = static_cast<int>(reader.i64());
+              state.sending = reader.boolean();
+              state.model_active = reader.boolean();
+              state.next_internal = reader.time<TIME>();
+              state.clock = reader.time<TIME>();
+              state.sent_at = reader.time<TIME>();
+              state.transfer_start = reader.time<TIME>();
+              state.retransmitted = reader.boolean();
+              state.rto.srtt = reader.f64();
+              state.rto.rttvar = reader.f64();
+              state.rto.rto = reader.f64();
+              state.rto.has_sample = reader.boolean();
+              rto_changed();
+              state.payload.reset();
+              if (has_payload){
+                new_payload();
+              }
+            }
+
             friend std::ostringstream& operator<<(std::ostringstream& os, const typename Sender<TIME>::state_type& i) {
                 os << "packetNum: " << i.packetNum << " & totalPacketNum: " << i.totalPacketNum; 
             return os;
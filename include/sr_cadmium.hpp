@@ -0,0 +1,371 @@
+/**
+ *\brief Selective Repeat sender and receiver models.
+ *
+ * Detailed Description : sliding window variants of Sender and Receiver.
+ * As with Go-Back-N (gbn_cadmium.hpp) the sender keeps up to window_size
+ * packets on the wire, but every packet has its own timer and only the
+ * packet whose timer expires is sent again. The receiver keeps the packets
+ * received out of order inside its window and acknowledges every packet on
+ * its own, so a loss costs one retransmission instead of a whole window.
+ *
+ * Both models use the ports of sender_defs and receiver_defs and plug into
+ * the same couplings as Sender and Receiver (see make_abp_link). The
+ * acknowledgements of the receiver are window_ack packets, logged as
+ * seq * 10 + bit.
+ */
+
+#ifndef __SR_CADMIUM_HPP__
+#define __SR_CADMIUM_HPP__
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/message_bag.hpp>
+#include <limits>
+#include <assert.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "message.hpp"
+#include "packet.hpp"
+#include "payload_pool.hpp"
+#include "delay_line.hpp"
+#include "gbn_cadmium.hpp"
+
+using namespace cadmium;
+using namespace std;
+
+/**
+ * The class SrSender sends the packets of a control message with a
+ * Selective Repeat window.
+ */
+
+template<typename TIME>
+class SrSender{
+    /**< putting definitions in context*/
+    using defs=sender_defs;
+    public:
+    /**<time to prepare one new packet*/
+    TIME   PREPARATION_TIME;
+    /**<time waited for the acknowledgement of every packet*/
+    TIME   timeout;
+    /**<packets sent and not acknowledged at most*/
+    uint32_t window_size;
+    /**<payload bytes of every data packet*/
+    uint32_t payload_length;
+
+    SrSender() noexcept{
+        PREPARATION_TIME  = TIME("00:00:10");
+        timeout           = TIME("00:00:20");
+        window_size       = 1;
+        payload_length    = 0;
+        reset();
+    }
+
+    /**
+     * @param window_size packets on the wire at most (at least 1)
+     * @param payload_length payload bytes of every data packet
+     */
+    SrSender(uint32_t window_size, uint32_t payload_length) noexcept
+        : SrSender(){
+        this->window_size = window_size > 0 ? window_size : 1;
+        this->payload_length = payload_length;
+    }
+
+    /**
+     * @param window_size packets on the wire at most (at least 1)
+     * @param payload_length payload bytes of every data packet
+     * @param preparation_time time to prepare one new packet
+     * @param timeout time waited for the acknowledgement of every packet
+     */
+    SrSender(uint32_t window_size, uint32_t payload_length,
+        TIME preparation_time, TIME timeout) noexcept
+        : SrSender(window_size, payload_length){
+        PREPARATION_TIME = preparation_time;
+        this->timeout = timeout;
+    }
+
+    /**
+     * Puts back the state of a new sender, the parameters are kept.
+     */
+    void reset() {
+        state = state_type();
+        state.base        = 1;
+        state.next_seq    = 1;
+        state.last_seq    = 0;
+        state.model_active = false;
+        state.send_in     = std::numeric_limits<TIME>::infinity();
+    }
+
+    /**<packet on the wire, kept until it is acknowledged*/
+    struct outstanding_packet{
+        payload_handle payload;
+        typename delay_line<TIME, int64_t>::ticket timer;
+    };
+
+    struct state_type{
+        int64_t base;               /**<oldest packet not acknowledged*/
+        int64_t next_seq;           /**<next new packet*/
+        int64_t last_seq;           /**<last packet of the transfer*/
+        bool model_active;
+        TIME send_in;               /**<time until next_seq is ready*/
+        payload_handle preparing;   /**<payload of next_seq*/
+        std::map<int64_t, outstanding_packet> window;   /**<not acknowledged*/
+        delay_line<TIME, int64_t> timers;   /**<timeouts of the window*/
+        std::vector<int64_t> acked; /**<packets to report on ack_received_out*/
+    };
+    state_type state;
+
+    using input_ports=std::tuple<typename defs::control_in, typename defs::ack_in>;
+    using output_ports=std::tuple<typename defs::packet_sent_out,
+        typename defs::ack_received_out, typename defs::data_out>;
+
+    /**
+     * Reports the acknowledged packets, or sends the packet prepared and
+     * the packets whose timer expired.
+     */
+    void internal_transition() {
+        if (!state.acked.empty()){
+            state.acked.clear();
+            return;
+        }
+        const TIME elapsed = time_advance();
+        state.send_in = window_timer_left(state.send_in, elapsed);
+        state.timers.advance(elapsed);
+        if (state.timers.next() == TIME()){
+            for (int64_t seq : state.timers.pop_due()){
+                state.window[seq].timer = state.timers.push(timeout, seq);
+            }
+        }
+        if (state.send_in == TIME()){
+            const int64_t seq = state.next_seq++;
+            outstanding_packet &sent = state.window[seq];
+            sent.payload = std::move(state.preparing);
+            sent.timer = state.timers.push(timeout, seq);
+            state.send_in = std::numeric_limits<TIME>::infinity();
+            start_preparation();
+        }
+    }
+
+    /**
+     * A control message starts a transfer of that many more packets when
+     * the sender is passive. An acknowledgement stops the timer of its
+     * packet, and the window slides over the packets acknowledged.
+     * @param e time elapsed since the last transition
+     * @param mbs messages received
+     */
+    void external_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        state.send_in = window_timer_left(state.send_in, e);
+        state.timers.advance(e);
+        for (const auto &x : get_messages<typename defs::control_in>(mbs)){
+            if (state.model_active == false){
+                const int64_t packets = static_cast<int64_t>(x.value);
+                if (packets > 0){
+                    state.last_seq = state.next_seq - 1 + packets;
+                    state.model_active = true;
+                    start_preparation();
+                }
+            }
+        }
+        for (const auto &x : get_messages<typename defs::ack_in>(mbs)){
+            auto acked = state.window.find(static_cast<int64_t>(x.seq));
+            if (!state.model_active || acked == state.window.end()){
+                continue;
+            }
+            state.timers.erase(acked->second.timer);
+            state.acked.push_back(acked->first);
+            state.window.erase(acked);
+            state.base = state.window.empty() ? state.next_seq :
+                state.window.begin()->first;
+            start_preparation();
+            if (state.base > state.last_seq){
+                state.model_active = false;
+            }
+        }
+    }
+
+    void confluence_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+    }
+
+    typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+        message_t out;
+        if (!state.acked.empty()){
+            for (int64_t seq : state.acked){
+                out.value = seq;
+                get_messages<typename defs::ack_received_out>(bags).push_back(out);
+            }
+            return bags;
+        }
+        const TIME next = time_advance();
+        if (state.timers.next() == next){
+            state.timers.for_each_due([&](int64_t seq){
+                send(bags, seq, state.window.at(seq).payload);
+            });
+        }
+        if (state.send_in == next){
+            send(bags, state.next_seq, state.preparing);
+        }
+        return bags;
+    }
+
+    TIME time_advance() const {
+        if (!state.acked.empty()){
+            return TIME();
+        }
+        const TIME timer = state.timers.next();
+        return timer < state.send_in ? timer : state.send_in;
+    }
+
+    friend std::ostringstream& operator<<(std::ostringstream& os,
+        const typename SrSender<TIME>::state_type& i) {
+        os << "base: " << i.base << " & nextSeq: " << i.next_seq
+           << " & lastSeq: " << i.last_seq;
+        return os;
+    }
+
+    private:
+    /**
+     * Starts preparing next_seq when nothing is being prepared and the
+     * window has room for it.
+     */
+    void start_preparation() {
+        if (state.send_in == std::numeric_limits<TIME>::infinity() &&
+            state.next_seq <= state.last_seq &&
+            state.next_seq < state.base + static_cast<int64_t>(window_size)){
+            state.preparing = window_payload(state.next_seq, payload_length);
+            state.send_in = PREPARATION_TIME;
+        }
+    }
+
+    void send(typename make_message_bags<output_ports>::type &bags,
+        int64_t seq, const payload_handle &payload) const {
+        packet_t packet(packet_kind::data, seq, static_cast<uint8_t>(seq % 2),
+            payload_length);
+        packet.payload = payload;
+        get_messages<typename defs::data_out>(bags).push_back(std::move(packet));
+        message_t out;
+        out.value = seq;
+        get_messages<typename defs::packet_sent_out>(bags).push_back(out);
+    }
+};
+
+/**
+ * The class SrReceiver accepts every packet of its window, delivers them in
+ * order and acknowledges each of them PREPARATION_TIME after it arrives.
+ */
+
+template<typename TIME>
+class SrReceiver{
+    /**< putting definitions in context*/
+    using defs=receiver_defs;
+    public:
+    /**<time between a packet and its acknowledgement*/
+    TIME   PREPARATION_TIME;
+    /**<packets accepted ahead of the next one expected*/
+    uint32_t window_size;
+
+    SrReceiver() noexcept{
+        PREPARATION_TIME  = TIME("00:00:10");
+        window_size       = 1;
+        reset();
+    }
+
+    /**
+     * @param window_size same window as the sender
+     */
+    SrReceiver(uint32_t window_size) noexcept : SrReceiver(){
+        this->window_size = window_size > 0 ? window_size : 1;
+    }
+
+    /**
+     * @param window_size same window as the sender
+     * @param preparation_time time between a packet and its acknowledgement
+     */
+    SrReceiver(uint32_t window_size, TIME preparation_time) noexcept
+        : SrReceiver(window_size){
+        PREPARATION_TIME = preparation_time;
+    }
+
+    /**
+     * Puts back the state of a new receiver, the parameters are kept.
+     */
+    void reset() {
+        state = state_type();
+        state.expected    = 1;
+        state.bytes_received = 0;
+    }
+
+    struct state_type{
+        uint64_t expected;          /**<next packet delivered in order*/
+        uint64_t bytes_received;    /**<payload bytes of distinct packets*/
+        std::set<uint64_t> buffered;    /**<received after a missing one*/
+        delay_line<TIME, packet_t> acks;    /**<acknowledgements being prepared*/
+    };
+    state_type state;
+
+    using input_ports=std::tuple<typename defs::input>;
+    using output_ports=std::tuple<typename defs::output>;
+
+    void internal_transition() {
+        state.acks.advance(state.acks.next());
+        state.acks.pop_due();
+    }
+
+    /**
+     * Keeps the packets of the window and acknowledges them, packets
+     * already delivered are acknowledged again since their acknowledgement
+     * may have been lost.
+     * @param e time elapsed since the last transition
+     * @param mbs packets received
+     */
+    void external_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        state.acks.advance(e);
+        for (const auto &x : get_messages<typename defs::input>(mbs)){
+            if (x.seq >= state.expected + window_size){
+                continue;
+            }
+            if (x.seq >= state.expected && state.buffered.insert(x.seq).second){
+                state.bytes_received += x.payload.size();
+                while (state.buffered.erase(state.expected) > 0){
+                    state.expected ++;
+                }
+            }
+            state.acks.push(PREPARATION_TIME,
+                packet_t(packet_kind::window_ack, x.seq, x.bit));
+        }
+    }
+
+    void confluence_transition(TIME e,
+        typename make_message_bags<input_ports>::type mbs) {
+        internal_transition();
+        external_transition(TIME(), std::move(mbs));
+    }
+
+    typename make_message_bags<output_ports>::type output() const {
+        typename make_message_bags<output_ports>::type bags;
+        state.acks.for_each_due([&bags](const packet_t &ack){
+            get_messages<typename defs::output>(bags).push_back(ack);
+        });
+        return bags;
+    }
+
+    TIME time_advance() const {
+        return state.acks.next();
+    }
+
+    friend std::ostringstream& operator<<(std::ostringstream& os,
+        const typename SrReceiver<TIME>::state_type& i) {
+        os << "ackNum: " << i.expected - 1 << " & bytesReceived: "
+           << i.bytes_received << " & buffered: " << i.buffered.size();
+        return os;
+    }
+};
+
+#endif // __SR_CADMIUM_HPP__
@@ -0,0 +1,240 @@
+/**
+ * \brief steady state detection and batch means of a running simulation.
+ *
+ * A run that only measures the long run throughput and latency does not
+ * need a fixed horizon: once the warm-up is over, the measures are
+ * estimated with batch means and the run can stop as soon as their
+ * confidence intervals are narrow enough.
+ *
+ * The warm-up is found with MSER-5: the observations are grouped in
+ * batches of MSER_BATCH, and the number d of batches deleted is the one
+ * that minimizes
+ *
+ *   MSER(d) = sum over i > d of (Y_i - mean of Y_{d+1..m})^2 / (m - d)^2
+ *
+ * for d up to m / 2. The observations left are split in
+ * STEADY_STATE_BATCHES batches whose means give a 95% confidence interval
+ * (estimate_interval of replication.hpp).
+ *
+ * steady_state_monitor is given to the logger sink in front of the log and
+ * takes two series from the log lines while the simulation runs: the
+ * acknowledgements per second over intervals of a fixed length, and the
+ * latency of every packet acknowledged, from the first time it was sent to
+ * its acknowledgement. Every line is passed on unchanged to the stream
+ * buffer that was behind the sink.
+ */
+
+#ifndef _STEADY_STATE_HPP_
+#define _STEADY_STATE_HPP_
+
+#include <cmath>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_line_streambuf.hpp"
+#include "log_parser.hpp"
+#include "replication.hpp"
+
+/**<observations per batch of MSER-5*/
+static constexpr size_t MSER_BATCH = 5;
+/**<batches of the batch means after the warm-up*/
+static constexpr size_t STEADY_STATE_BATCHES = 20;
+/**<observations per batch at least before an interval is computed*/
+static constexpr size_t STEADY_STATE_MIN_BATCH = 5;
+
+/**
+ * Finds the warm-up of a series with MSER.
+ * @param x observations in time order
+ * @param batch observations per batch (MSER_BATCH for MSER-5)
+ * @return the number of observations to delete, a multiple of batch
+ */
+
+inline size_t mser_truncation(const std::vector<double> &x,
+    size_t batch = MSER_BATCH){
+    const size_t m = x.size() / batch;
+    if(m < 2){
+        return 0;
+    }
+    std::vector<double> means(m, 0.0);
+    for(size_t i = 0; i < m; i++){
+        for(size_t j = 0; j < batch; j++){
+            means[i] += x[i * batch + j];
+        }
+        means[i] /= batch;
+    }
+    // sums of the batch means from d to the end, so every d is O(1)
+    std::vector<double> sum(m + 1, 0.0), squares(m + 1, 0.0);
+    for(size_t i = m; i > 0; i--){
+        sum[i - 1] = sum[i] + means[i - 1];
+        squares[i - 1] = squares[i] + means[i - 1] * means[i - 1];
+    }
+    size_t best = 0;
+    double best_value = INFINITY;
+    for(size_t d = 0; d <= m / 2; d++){
+        const double n = static_cast<double>(m - d);
+        const double deviations = squares[d] - sum[d] * sum[d] / n;
+        const double value = (deviations > 0 ? deviations : 0) / (n * n);
+        if(value < best_value){
+            best_value = value;
+            best = d;
+        }
+    }
+    return best * batch;
+}
+
+/**
+ * Steady state estimate of one series.
+ */
+
+struct steady_state_estimate{
+    size_t observations = 0;    /**<observations of the series*/
+    size_t truncated = 0;       /**<observations deleted as warm-up*/
+    size_t batch_size = 0;      /**<observations per batch, 0 if too few*/
+    interval_estimate interval; /**<mean of the batch means and its 95% CI*/
+
+    /**
+     * @return the half width over the mean, infinity without an interval
+     */
+    double relative_half_width() const{
+        if(batch_size == 0 || interval.mean == 0){
+            return INFINITY;
+        }
+        return interval.half_width / std::fabs(interval.mean);
+    }
+};
+
+/**
+ * Deletes the warm-up of a series and computes the batch means of the
+ * rest. The oldest observations left over by the batches are not used.
+ * @param x observations in time order
+ * @param batches number of batches
+ * @return the estimate, with a batch_size of 0 when the series is too short
+ */
+
+inline steady_state_estimate estimate_steady_state(const std::vector<double> &x,
+    size_t batches = STEADY_STATE_BATCHES){
+    steady_state_estimate estimate;
+    estimate.observations = x.size();
+    estimate.truncated = mser_truncation(x);
+    const size_t kept = x.size() - estimate.truncated;
+    if(batches == 0 || kept / batches < STEADY_STATE_MIN_BATCH){
+        return estimate;
+    }
+    estimate.batch_size = kept / batches;
+    const size_t first = x.size() - batches * estimate.batch_size;
+    std::vector<double> means(batches, 0.0);
+    for(size_t i = 0; i < batches; i++){
+        for(size_t j = 0; j < estimate.batch_size; j++){
+            means[i] += x[first + i * estimate.batch_size + j];
+        }
+        means[i] /= estimate.batch_size;
+    }
+    estimate.interval = estimate_interval(means);
+    return estimate;
+}
+
+class steady_state_monitor : public log_line_streambuf{
+    public:
+    /**
+     * @param interval seconds of one throughput observation
+     * @param next stream buffer that receives the log lines, can be null
+     */
+    steady_state_monitor(double interval, std::streambuf *next)
+        : interval(interval), next(next){}
+
+    /**
+     * Closes the throughput observations that end at seconds or before.
+     * Called with the time the runner stopped at, since no line is written
+     * for the intervals without any event.
+     * @param seconds simulated time
+     */
+    void advance_to(double seconds){
+        while((throughput_series.size() + 1) * interval <= seconds){
+            throughput_series.push_back(acks / interval);
+            acks = 0;
+        }
+    }
+
+    /**
+     * @return acknowledgements per second of every closed interval
+     */
+    const std::vector<double>& throughput() const{
+        return throughput_series;
+    }
+
+    /**
+     * @return seconds from the first copy to the acknowledgement of every
+     * packet acknowledged, in the order of the acknowledgements
+     */
+    const std::vector<double>& latency() const{
+        return latency_series;
+    }
+
+    protected:
+    void on_line(std::string_view line) override{
+        if(next != nullptr){
+            next->sputn(line.data(), line.size());
+            next->sputc('\n');
+        }
+        if(is_time_line(line)){
+            time = log_time_to_seconds(line);
+            advance_to(time);
+            return;
+        }
+        std::string_view model;
+        for_each_port_value(line, model,
+            [&](std::string_view port, std::string_view values){
+                if(port != "packet_sent_out" && port != "ack_received_out"){
+                    return;
+                }
+                std::map<std::string, double> &sent = outstanding[std::string(model)];
+                while(!values.empty()){
+                    const size_t comma = values.find(',');
+                    std::string_view value = values.substr(0, comma);
+                    values = comma == std::string_view::npos ?
+                        std::string_view() : values.substr(comma + 1);
+                    while(!value.empty() && value.front() == ' '){
+                        value.remove_prefix(1);
+                    }
+                    if(port == "packet_sent_out"){
+                        sent.emplace(std::string(value), time);
+                    }else{
+                        acknowledged(sent, value);
+                    }
+                }
+            });
+    }
+
+    private:
+    /**
+     * Takes the latency of an acknowledged packet. The sliding window
+     * senders report the number of the packet, the alternating bit sender
+     * its bit, and it has a single packet on the way.
+     */
+    void acknowledged(std::map<std::string, double> &sent,
+        std::string_view value){
+        acks++;
+        auto packet = sent.find(std::string(value));
+        if(packet == sent.end() || sent.size() == 1){
+            packet = sent.begin();
+        }
+        if(packet != sent.end()){
+            latency_series.push_back(time - packet->second);
+            sent.erase(packet);
+        }
+    }
+
+    double interval;
+    std::streambuf *next;
+    double time = 0;
+    long acks = 0;                  /**<acknowledgements of the open interval*/
+    std::vector<double> throughput_series;
+    std::vector<double> latency_series;
+    /**<first send time of the packets not acknowledged, per sender*/
+    std::map<std::string, std::map<std::string, double>> outstanding;
+};
+
+#endif // _STEADY_STATE_HPP_
@@ -0,0 +1,61 @@
+/**
+ * \brief output_filter and limit_output applied while the simulation runs.
+ *
+ * streaming_filter_streambuf is given to the logger sink instead of the raw
+ * log file. Every logger line is turned into rows of the output table as
+ * soon as it is written, and the rows that match the limit structures are
+ * written to the limit table at the same time. The raw log is only written
+ * when it is asked for. Only the current line is kept in memory, so the
+ * memory used does not depend on the length of the run.
+ */
+
+#ifndef _STREAMING_FILTER_HPP_
+#define _STREAMING_FILTER_HPP_
+
+#include <stdio.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "limit.hpp"
+#include "log_line_streambuf.hpp"
+
+class streaming_filter_streambuf : public log_line_streambuf{
+    public:
+    streaming_filter_streambuf() = default;
+    ~streaming_filter_streambuf();
+
+    /**
+     * Opens the output files and writes the table headings.
+     * @param output path of the output table (output.txt)
+     * @param limit path of the limit table (limit_output.txt)
+     * @param limits rows written to the limit table, same rule as limit_output
+     * @param raw path of the raw log, NULL to not write it
+     * @return false if a file cannot be opened
+     */
+    bool open(const char *output, const char *limit,
+        const std::vector<compare> &limits, const char *raw = NULL);
+
+    /**
+     * Writes the last rows and closes the files.
+     */
+    void close();
+
+    protected:
+    void on_line(std::string_view line) override;
+
+    private:
+    FILE *op = NULL;
+    FILE *lp = NULL;
+    FILE *rp = NULL;
+    std::vector<compare> limits;
+    std::string time;
+    std::string component;
+    std::string port;
+    std::string port_value;
+    std::vector<char> row;
+    long limit_rows = 0;
+};
+
+#endif // _STREAMING_FILTER_HPP_
@@ -23,15 +23,20 @@
 #include <random>
 
 #include "message.hpp"
+#include "packet.hpp"
+#include "channel_model.hpp"
+#include "time_conversion.hpp"
+#include "delay_line.hpp"
+#include "checkpoint.hpp"
 
 using namespace cadmium;
 using namespace std;
 
 //Port definition
 struct subnet_defs{
-    struct output : public out_port<message_t> {
+    struct output : public out_port<packet_t> {
     };
-    struct input : public in_port<message_t> {
+    struct input : public in_port<packet_t> {
     };
 };
 //This is a meta-model, it should be overloaded for declaring the "id" parameter
@@ -40,18 +45,49 @@ class Subnet{
     using defs=subnet_defs; // putting definitions in context
     public:
     //Parameters to be overwritten when instantiating the atomic model
-           
+    //Delay and loss of the packets, normal(3,1) seconds and 5% loss by default
+    channel_model channel;
+
     // default constructor
     Subnet() noexcept{
         state.transmiting     = false;
         state.index           = 0;
     }
+
+    // constructor with the seed of the random numbers of this subnet, so
+    // independent replications can run side by side
+    Subnet(unsigned int seed) noexcept : Subnet(){
+        channel.seed(seed);
+    }
+
+    // constructor with the delay and loss models of this subnet
+    Subnet(const channel_config &config, unsigned int seed) : Subnet(){
+        channel = channel_model(config, seed);
+    }
+
+    // puts back the state of a new subnet and seeds its channel again, the
+    // delay and loss models are kept
+    void reset(unsigned int seed) {
+        state.transmiting     = false;
+        state.index           = 0;
+        state.in_flight       = delay_line<TIME, in_flight_packet>();
+        channel.seed(seed);
+    }
             
+    // a packet on the wire, a lost packet is kept until its delay is over
+    // so that the subnet wakes up at the same times whether it is lost or not
+    struct in_flight_packet{
+        packet_t packet;
+        bool lost;
+    };
+
     // state definition
+    // the subnet is pipelined: every packet has its own delay, so a window
+    // of packets can be on the wire at once and they leave in delay order
     struct state_type{
         bool transmiting;
-        int packet;
         int index;
+        delay_line<TIME, in_flight_packet> in_flight;
     };
     state_type state;
     // ports definition
@@ -60,20 +96,27 @@ class Subnet{
 
     // internal transition
     void internal_transition() {
-        state.transmiting = false;
+        // the packets were forwarded (or lost), drop their payload references
+        state.in_flight.advance(state.in_flight.next());
+        state.in_flight.pop_due();
+        state.transmiting = !state.in_flight.empty();
     }
 
     // external transition
     void external_transition(TIME e,
         typename make_message_bags<input_ports>::type mbs) {
             state.index ++;
-            if(get_messages<typename defs::input>(mbs).size()>1){
-                assert(false && "One message at a time");
-            }
+            state.in_flight.advance(e);
             for (const auto &x : get_messages<typename defs::input>(mbs)){
-                state.packet = static_cast < int > (x.value);
-                state.transmiting = true;
+                // the fate of the packet is drawn once, when it arrives
+                const TIME delay = seconds_to_time<TIME>(channel.next_delay());
+                in_flight_packet sent{x, channel.next_lost()};
+                if (sent.lost){
+                    sent.packet.payload.reset();
+                }
+                state.in_flight.push(delay, std::move(sent));
             }
+            state.transmiting = !state.in_flight.empty();
     }
 
     // confluence transition
@@ -86,28 +129,40 @@ class Subnet{
     // output function
     typename make_message_bags<output_ports>::type output() const {
         typename make_message_bags<output_ports>::type bags;
-        message_t out;
-        if ((double)rand() / (double) RAND_MAX  < 0.95){
-            out.value = state.packet;
-            get_messages<typename defs::output>(bags).push_back(out);
-        }
+        state.in_flight.for_each_due([&bags](const in_flight_packet &sent){
+            if (!sent.lost){
+                get_messages<typename defs::output>(bags).push_back(sent.packet);
+            }
+        });
         return bags;
     }
 
     // time_advance function
     TIME time_advance() const {
-        std::default_random_engine generator;
-        std::normal_distribution<double> distribution(3.0, 1.0);
-        TIME next_internal;
-        if (state.transmiting) {
-            std::initializer_list<int> time =
-            {0, 0, static_cast < int > (round(distribution(generator)))};
-            // time is hour min and second
-            next_internal = TIME(time);
-        }else {
-             next_internal = std::numeric_limits<TIME>::infinity();
-         }
-        return next_internal;
+        return state.in_flight.next();
+    }
+
+    // writes the state and the random engines to a checkpoint
+    void save_checkpoint(checkpoint_writer &writer) const {
+        writer.boolean(state.transmiting);
+        writer.i64(state.index);
+        state.in_flight.save_checkpoint(writer,
+            [](checkpoint_writer &w, const in_flight_packet &sent){
+                save_packet_checkpoint(w, sent.packet);
+                w.boolean(sent.lost);
+            });
+        channel.save_checkpoint(writer);
+    }
+
+    void load_checkpoint(checkpoint_reader &reader) {
+        state.transmiting = reader.boolean();
+        state.index = static_cast<int>(reader.i64());
+        state.in_flight.load_checkpoint(reader,
+            [](checkpoint_reader &r, in_flight_packet &sent){
+                load_packet_checkpoint(r, sent.packet);
+                sent.lost = r.boolean();
+            });
+        channel.load_checkpoint(reader);
     }
 
     friend std::ostringstream& operator<<(std::ostringstream& os,
@@ -0,0 +1,248 @@
+/**
+ * \brief integer TIME of the models, counted in milliseconds.
+ *
+ * The protocol models only need times of seconds and milliseconds: every
+ * constant, every delay (seconds_to_time rounds to the millisecond) and
+ * every input event is a whole number of milliseconds. tick_time keeps
+ * such a time in one int64_t, so adding, subtracting and comparing two
+ * times are single integer instructions, and infinity is the largest
+ * int64_t. It can be used wherever NDTime is:
+ *
+ *   tick_time t1("00:00:10");           hh:mm:ss
+ *   tick_time t2("00:00:10:500");       hh:mm:ss:mmm
+ *   tick_time t3({0, 0, 10, 500});      {hours, minutes, seconds, ms}
+ *   std::numeric_limits<tick_time>::infinity()
+ *
+ * and it is printed as "hh:mm:ss:mmm", like NDTime, so the logs of both
+ * types are the same. Adding anything to infinity, or subtracting a
+ * finite time from it, gives infinity.
+ */
+
+#ifndef _TICK_TIME_HPP_
+#define _TICK_TIME_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <charconv>
+#include <cmath>
+#include <initializer_list>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "time_conversion.hpp"
+
+class tick_time{
+    public:
+    /**<ticks per second*/
+    static constexpr int64_t TICKS_PER_SECOND = 1000;
+    /**<ticks of infinity*/
+    static constexpr int64_t INFINITE_TICKS = std::numeric_limits<int64_t>::max();
+
+    constexpr tick_time() noexcept = default;
+
+    /**
+     * @param fields {hours, minutes, seconds, milliseconds}, missing fields
+     * are 0
+     */
+    tick_time(std::initializer_list<int> fields){
+        if(fields.size() > 4){
+            throw std::invalid_argument("tick_time has no unit below the millisecond");
+        }
+        static constexpr int64_t units[4] = {3600000, 60000, 1000, 1};
+        int index = 0;
+        for(int field : fields){
+            value += field * units[index++];
+        }
+    }
+
+    /**
+     * @param text "hh:mm:ss", "hh:mm:ss:mmm" or "inf"
+     */
+    tick_time(std::string_view text){
+        parse(text);
+    }
+
+    tick_time(const std::string &text) : tick_time(std::string_view(text)){}
+
+    tick_time(const char *text) : tick_time(std::string_view(text)){}
+
+    /**
+     * @param ticks milliseconds, INFINITE_TICKS for infinity
+     * @return the time
+     */
+    static constexpr tick_time from_ticks(int64_t ticks) noexcept{
+        tick_time time;
+        time.value = ticks;
+        return time;
+    }
+
+    /**
+     * @return milliseconds, INFINITE_TICKS for infinity
+     */
+    constexpr int64_t ticks() const noexcept{
+        return value;
+    }
+
+    constexpr bool is_infinity() const noexcept{
+        return value == INFINITE_TICKS;
+    }
+
+    constexpr tick_time operator+(const tick_time &other) const noexcept{
+        return is_infinity() || other.is_infinity() ?
+            from_ticks(INFINITE_TICKS) : from_ticks(value + other.value);
+    }
+
+    constexpr tick_time operator-(const tick_time &other) const noexcept{
+        return is_infinity() ? *this : from_ticks(value - other.value);
+    }
+
+    tick_time& operator+=(const tick_time &other) noexcept{
+        return *this = *this + other;
+    }
+
+    tick_time& operator-=(const tick_time &other) noexcept{
+        return *this = *this - other;
+    }
+
+    constexpr bool operator==(const tick_time &other) const noexcept{
+        return value == other.value;
+    }
+
+    constexpr bool operator!=(const tick_time &other) const noexcept{
+        return value != other.value;
+    }
+
+    constexpr bool operator<(const tick_time &other) const noexcept{
+        return value < other.value;
+    }
+
+    constexpr bool operator>(const tick_time &other) const noexcept{
+        return value > other.value;
+    }
+
+    constexpr bool operator<=(const tick_time &other) const noexcept{
+        return value <= other.value;
+    }
+
+    constexpr bool operator>=(const tick_time &other) const noexcept{
+        return value >= other.value;
+    }
+
+    /**
+     * Writes the time as "hh:mm:ss:mmm", or "inf".
+     */
+    friend std::ostream& operator<<(std::ostream &os, const tick_time &time){
+        if(time.is_infinity()){
+            return os << "inf";
+        }
+        const int64_t ticks = time.value < 0 ? -time.value : time.value;
+        char text[40];
+        snprintf(text, sizeof(text), "%s%02lld:%02lld:%02lld:%03lld",
+            time.value < 0 ? "-" : "", (long long)(ticks / 3600000),
+            (long long)(ticks / 60000 % 60), (long long)(ticks / 1000 % 60),
+            (long long)(ticks % 1000));
+        return os << text;
+    }
+
+    friend std::istream& operator>>(std::istream &is, tick_time &time){
+        std::string text;
+        if(is >> text){
+            try{
+                time.parse(text);
+            }catch(const std::invalid_argument &){
+                is.setstate(std::ios::failbit);
+            }
+        }
+        return is;
+    }
+
+    private:
+    /**
+     * Reads "hh:mm:ss", "hh:mm:ss:mmm" or "inf", a leading '-' gives a
+     * negative time.
+     */
+    void parse(std::string_view text){
+        if(text == "inf"){
+            value = INFINITE_TICKS;
+            return;
+        }
+        const bool negative = !text.empty() && text.front() == '-';
+        if(negative){
+            text.remove_prefix(1);
+        }
+        static constexpr int64_t units[4] = {3600000, 60000, 1000, 1};
+        int64_t ticks = 0;
+        int count = 0;
+        const char *first = text.data();
+        const char *last = first + text.size();
+        while(count < 4){
+            int64_t field = 0;
+            std::from_chars_result parsed = std::from_chars(first, last, field);
+            if(parsed.ec != std::errc()){
+                break;
+            }
+            ticks += field * units[count++];
+            first = parsed.ptr;
+            if(first == last || *first != ':'){
+                break;
+            }
+            first++;
+        }
+        if(count < 3 || first != last){
+            throw std::invalid_argument("cannot read the time " + std::string(text));
+        }
+        value = negative ? -ticks : ticks;
+    }
+
+    int64_t value = 0;
+};
+
+namespace std{
+    template<>
+    class numeric_limits<tick_time>{
+        public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool has_infinity = true;
+
+        static constexpr tick_time infinity() noexcept{
+            return tick_time::from_ticks(tick_time::INFINITE_TICKS);
+        }
+
+        static constexpr tick_time max() noexcept{
+            return tick_time::from_ticks(tick_time::INFINITE_TICKS - 1);
+        }
+
+        static constexpr tick_time lowest() noexcept{
+            return tick_time::from_ticks(numeric_limits<int64_t>::lowest());
+        }
+    };
+}
+
+/**
+ * Seconds of a finite tick_time, without printing it.
+ * @param time
+ * @return time in seconds
+ */
+
+inline double time_to_seconds(const tick_time &time){
+    return static_cast<double>(time.ticks()) / tick_time::TICKS_PER_SECOND;
+}
+
+/**
+ * tick_time of a number of seconds, rounded to the millisecond as for
+ * every other TIME.
+ * @param seconds time in seconds (negative values give 0)
+ * @return the time
+ */
+
+template<>
+inline tick_time seconds_to_time<tick_time>(double seconds){
+    return tick_time::from_ticks(seconds > 0 ? std::llround(seconds * 1000) : 0);
+}
+
+#endif // _TICK_TIME_HPP_
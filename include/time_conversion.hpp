@@ -0,0 +1,77 @@
+/**
+ * \brief conversions between the TIME of the models and seconds.
+ *
+ * The models only rely on TIME being built from an initializer list
+ * {hours, minutes, seconds, milliseconds} and being printed as
+ * "hh:mm:ss:mmm", which is what NDTime does. These helpers are the only
+ * place where a TIME is turned into a number of seconds and back. A TIME
+ * that gives its fields (getHours() ... getMilliseconds(), as NDTime does)
+ * is converted from them; the others are printed and read back, which
+ * costs a string, so the models keep it off their transitions.
+ */
+
+#ifndef _TIME_CONVERSION_HPP_
+#define _TIME_CONVERSION_HPP_
+
+#include <cmath>
+#include <initializer_list>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+#include "log_parser.hpp"
+
+/**
+ * Builds a TIME from a number of seconds, rounded to the millisecond.
+ * @param seconds time in seconds (negative values give 0)
+ * @return the TIME
+ */
+
+template<typename TIME>
+TIME seconds_to_time(double seconds){
+    long long milliseconds = seconds > 0 ? std::llround(seconds * 1000) : 0;
+    std::initializer_list<int> time = {
+        static_cast<int>(milliseconds / 3600000),
+        static_cast<int>(milliseconds / 60000 % 60),
+        static_cast<int>(milliseconds / 1000 % 60),
+        static_cast<int>(milliseconds % 1000)
+    };
+    // time is hour min second and millisecond
+    return TIME(time);
+}
+
+/**
+ * Tells whether TIME gives its hours, minutes, seconds and milliseconds.
+ */
+
+template<typename TIME, typename = void>
+struct has_time_fields : std::false_type{};
+
+template<typename TIME>
+struct has_time_fields<TIME, std::void_t<
+    decltype(std::declval<const TIME&>().getHours()),
+    decltype(std::declval<const TIME&>().getMinutes()),
+    decltype(std::declval<const TIME&>().getSeconds()),
+    decltype(std::declval<const TIME&>().getMilliseconds())>> : std::true_type{};
+
+/**
+ * Gives the number of seconds of a finite TIME.
+ * @param time the TIME
+ * @return time in seconds
+ */
+
+template<typename TIME>
+double time_to_seconds(const TIME &time){
+    if constexpr (has_time_fields<TIME>::value){
+        const long long milliseconds =
+            ((static_cast<long long>(time.getHours()) * 60 + time.getMinutes()) * 60 +
+            time.getSeconds()) * 1000 + time.getMilliseconds();
+        return milliseconds / 1000.0;
+    }else{
+        std::ostringstream os;
+        os << time;
+        return log_time_to_seconds(os.str());
+    }
+}
+
+#endif // _TIME_CONVERSION_HPP_
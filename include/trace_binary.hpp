@@ -0,0 +1,191 @@
+/**
+ * \brief compact binary trace of the simulation messages.
+ *
+ * Instead of the text of the message logger, the binary trace stores one
+ * fixed size record per message:
+ *
+ *   time (ms) | model id | port id | value
+ *
+ * The messages of one bag ("{5, 6, 7}") are consecutive records, all but
+ * the first one flagged TRACE_SAME_BAG, so the bag can be written back as
+ * one row.
+ *
+ * Model and port names are interned: each name is stored once in a
+ * dictionary and the records only hold its index. The file starts with a
+ * header that gives the number of records and where the dictionary is, and
+ * the dictionary is written after the last record when the trace is closed
+ * (the names are only known once every model has produced its messages).
+ *
+ *   header | record 0 | record 1 | ... | dictionary
+ *
+ * trace_binary_streambuf writes the trace from the logger output,
+ * trace_reader reads it back and trace_to_output writes the same table as
+ * output_filter.
+ */
+
+#ifndef _TRACE_BINARY_HPP_
+#define _TRACE_BINARY_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "log_line_streambuf.hpp"
+
+/**<first bytes of every binary trace*/
+static constexpr char TRACE_MAGIC[8] = {'A','B','P','T','R','A','C','E'};
+static constexpr uint32_t TRACE_VERSION = 2;
+/**<flag of a record that is not the first message of its bag*/
+static constexpr uint32_t TRACE_SAME_BAG = 1;
+/**<flag of a record whose value is the integer member*/
+static constexpr uint32_t TRACE_INTEGER = 2;
+
+/**
+ * Header at the beginning of the file.
+ */
+
+struct trace_header{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    uint64_t dictionary_offset;  /**<offset of the dictionary from the start of the file*/
+};
+
+/**
+ * One message of one port of one model.
+ */
+
+struct trace_record{
+    int64_t time;       /**<simulation time in milliseconds*/
+    uint16_t model;     /**<index of the model name in the dictionary*/
+    uint16_t port;      /**<index of the port name in the dictionary*/
+    uint32_t flags;     /**<TRACE_SAME_BAG and TRACE_INTEGER*/
+    union{
+        double value;       /**<value of the message*/
+        int64_t integer;    /**<value of the message flagged TRACE_INTEGER*/
+    };
+};
+
+static_assert(sizeof(trace_record) == 24, "trace records must be 24 bytes");
+
+/**
+ * Stream buffer given to the logger sink. It parses the logger lines as
+ * they are written and turns every message into a trace_record.
+ */
+
+class trace_binary_streambuf : public log_line_streambuf{
+    public:
+    trace_binary_streambuf() = default;
+    ~trace_binary_streambuf();
+
+    /**
+     * Opens the trace file and writes an empty header.
+     * @param path path of the binary trace
+     * @return false if the file cannot be opened
+     */
+    bool open(const char *path);
+
+    /**
+     * Writes the pending records and the dictionary, then completes the
+     * header. Called by the destructor if needed.
+     */
+    void close();
+
+    protected:
+    void on_line(std::string_view line) override;
+
+    private:
+    uint16_t intern(std::unordered_map<std::string, uint16_t> &ids,
+        std::vector<std::string> &names, std::string_view name);
+    void write_records();
+
+    FILE *file = nullptr;
+    int64_t time = 0;
+    uint64_t record_count = 0;
+    std::vector<trace_record> records;
+    std::unordered_map<std::string, uint16_t> model_ids;
+    std::unordered_map<std::string, uint16_t> port_ids;
+    std::vector<std::string> model_names;
+    std::vector<std::string> port_names;
+};
+
+/**
+ * Reads a binary trace record by record.
+ */
+
+class trace_reader{
+    public:
+    trace_reader() = default;
+    ~trace_reader();
+
+    /**
+     * Opens a trace and loads its dictionary.
+     * @param path path of the binary trace
+     * @return false if the file cannot be opened or is not a trace
+     */
+    bool open(const char *path);
+
+    /**
+     * Reads the next record.
+     * @param record receives the record
+     * @return false at the end of the trace
+     */
+    bool next(trace_record &record);
+
+    uint64_t size() const { return header.record_count; }
+    const std::string& model_name(uint16_t id) const { return model_names[id]; }
+    const std::string& port_name(uint16_t id) const { return port_names[id]; }
+
+    private:
+    FILE *file = nullptr;
+    trace_header header = {};
+    uint64_t records_read = 0;
+    std::vector<trace_record> buffer;
+    size_t buffer_position = 0;
+    std::vector<std::string> model_names;
+    std::vector<std::string> port_names;
+};
+
+/**
+ * Writes a time in milliseconds as "hh:mm:ss:mmm".
+ * @param milliseconds time in milliseconds
+ * @param text buffer of at least 32 characters
+ */
+
+void format_trace_time(int64_t milliseconds, char *text);
+
+/**
+ * Reads the value of one message, an integer is kept as an integer so it
+ * is written back with all its digits.
+ * @param text value written by the message logger
+ * @param end receives the first character after the value
+ * @param record receives the value and the TRACE_INTEGER flag
+ * @return false if there is no number at text
+ */
+
+bool parse_trace_value(const char *text, char **end, trace_record &record);
+
+/**
+ * Writes the value of a record as the message logger does: an integer with
+ * all its digits, any other number in its shortest form that reads back
+ * exactly.
+ * @param record record of a message
+ * @param text buffer of at least 32 characters
+ */
+
+void format_trace_value(const trace_record &record, char *text);
+
+/**
+ * Converts a binary trace to the tabular format of output_filter.
+ * @param input path of the binary trace
+ * @param output path of the table to write
+ */
+
+void trace_to_output(const char *input, const char *output);
+
+#endif // _TRACE_BINARY_HPP_
@@ -0,0 +1,286 @@
+/**
+ * \brief columnar, compressed export of the messages of a simulation.
+ *
+ * The messages (time, component, port, value) are cut into chunks of
+ * COLUMNAR_CHUNK_ROWS rows and every chunk stores each column on its own:
+ *
+ *   time        first time, then the differences between consecutive times
+ *   component   index of the name in the component dictionary
+ *   port        index of the name in the port dictionary
+ *   value       value minus the smallest value of the chunk when every value
+ *               of the chunk is an integer, the doubles themselves otherwise
+ *   bag         1 for a message of the same bag as the one before it, 0 for
+ *               the first message of a bag
+ *
+ * A bag of several messages is one row of the output table ("v1, v2"); the
+ * directory gives the row of the first message of every chunk, and with
+ * the bag column the reader finds the row of every message.
+ *
+ * The numbers of a column are bit packed with the width of the largest one
+ * of the chunk, so a column of small numbers takes a few bits per row. The
+ * dictionaries and a directory of the chunks are written after the last
+ * chunk; the directory gives, for every chunk, where each column is and the
+ * smallest and largest time, component, port and value, so a reader can
+ * skip a chunk from its statistics and read one column of a chunk without
+ * reading or decoding the others.
+ *
+ *   header | chunk 0: time, component, port, value | chunk 1 | ... |
+ *   dictionaries | directory
+ *
+ * columnar_writer writes the file, columnar_reader reads it, and
+ * output_to_columnar, trace_to_columnar and columnar_to_output convert
+ * from and to the output table and the binary trace.
+ */
+
+#ifndef _TRACE_COLUMNAR_HPP_
+#define _TRACE_COLUMNAR_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "trace_binary.hpp"
+
+/**<first bytes of every columnar file*/
+static constexpr char COLUMNAR_MAGIC[8] = {'A','B','P','C','O','L','M','N'};
+static constexpr uint32_t COLUMNAR_VERSION = 2;
+/**<rows of a chunk, except the last one*/
+static constexpr uint32_t COLUMNAR_CHUNK_ROWS = 1 << 16;
+
+/**
+ * Columns of the file, in the order they are stored in a chunk.
+ */
+
+enum columnar_column : uint32_t{
+    COLUMNAR_TIME = 0,
+    COLUMNAR_COMPONENT = 1,
+    COLUMNAR_PORT = 2,
+    COLUMNAR_VALUE = 3,
+    COLUMNAR_BAG = 4,
+    COLUMNAR_COLUMNS = 5
+};
+
+/**
+ * How the numbers of a column are stored in a chunk.
+ */
+
+enum columnar_encoding : uint8_t{
+    COLUMNAR_DELTA = 0,     /**<first number, then zigzag differences, packed*/
+    COLUMNAR_PACKED = 1,    /**<number minus base, packed*/
+    COLUMNAR_DOUBLE = 2     /**<doubles, 8 bytes each*/
+};
+
+/**
+ * Header at the beginning of the file.
+ */
+
+struct columnar_header{
+    char magic[8];
+    uint32_t version;
+    uint32_t chunk_rows;
+    uint64_t row_count;
+    uint64_t chunk_count;
+    uint64_t dictionary_offset;  /**<offset of the dictionaries, followed by the directory*/
+};
+
+/**
+ * Where one column of one chunk is and how it is stored.
+ */
+
+struct columnar_block{
+    uint64_t offset;        /**<offset of the block from the start of the file*/
+    uint32_t size;          /**<bytes of the block*/
+    uint8_t encoding;       /**<columnar_encoding*/
+    uint8_t bit_width;      /**<bits of every packed number*/
+    uint16_t reserved;
+    int64_t base;           /**<first time (DELTA) or smallest number (PACKED)*/
+};
+
+/**
+ * Entry of the directory: one chunk, its columns and its statistics.
+ */
+
+struct columnar_chunk{
+    uint32_t rows;
+    uint32_t reserved;
+    uint64_t first_row;     /**<row of the output table of the first message*/
+    int64_t time_min;       /**<milliseconds*/
+    int64_t time_max;
+    uint32_t component_min; /**<dictionary indexes*/
+    uint32_t component_max;
+    uint32_t port_min;
+    uint32_t port_max;
+    double value_min;       /**<rounded to a double for large integers*/
+    double value_max;
+    columnar_block columns[COLUMNAR_COLUMNS];
+};
+
+/**
+ * Writes a columnar file one message at a time.
+ */
+
+class columnar_writer{
+    public:
+    columnar_writer() = default;
+    ~columnar_writer();
+
+    columnar_writer(const columnar_writer&) = delete;
+    columnar_writer& operator=(const columnar_writer&) = delete;
+
+    /**
+     * Opens the file and writes an empty header.
+     * @param path path of the columnar file
+     * @return false if the file cannot be opened
+     */
+    bool open(const char *path);
+
+    /**
+     * Adds a message, the chunk is written once it is full.
+     * @param message time, value and flags (TRACE_SAME_BAG, TRACE_INTEGER)
+     * of the message, its model and port ids are not used
+     * @param component name of the model
+     * @param port short name of the port
+     */
+    void add(const trace_record &message, std::string_view component,
+        std::string_view port);
+
+    /**
+     * Writes the last chunk, the dictionaries and the directory, then
+     * completes the header. Called by the destructor if needed.
+     */
+    void close();
+
+    uint64_t size() const { return row_count + times.size(); }
+
+    private:
+    uint32_t intern(std::unordered_map<std::string, uint32_t> &ids,
+        std::vector<std::string> &names, std::string_view name);
+    void write_chunk();
+    void write_block(columnar_block &block, const std::vector<uint8_t> &bytes);
+
+    FILE *file = nullptr;
+    uint64_t offset = 0;
+    uint64_t row_count = 0;
+    uint64_t table_rows = 0;
+    std::vector<int64_t> times;
+    std::vector<uint32_t> components;
+    std::vector<uint32_t> ports;
+    std::vector<trace_record> values;
+    std::vector<uint8_t> bags;
+    std::vector<columnar_chunk> chunks;
+    std::unordered_map<std::string, uint32_t> component_ids;
+    std::unordered_map<std::string, uint32_t> port_ids;
+    std::vector<std::string> component_names;
+    std::vector<std::string> port_names;
+};
+
+/**
+ * Reads the columns of a columnar file chunk by chunk.
+ */
+
+class columnar_reader{
+    public:
+    columnar_reader() = default;
+    ~columnar_reader();
+
+    columnar_reader(const columnar_reader&) = delete;
+    columnar_reader& operator=(const columnar_reader&) = delete;
+
+    /**
+     * Opens a file and loads its dictionaries and its directory.
+     * @param path path of the columnar file
+     * @return false if the file cannot be opened or is not a columnar file
+     */
+    bool open(const char *path);
+
+    uint64_t size() const { return header.row_count; }
+    size_t chunk_count() const { return chunks.size(); }
+    const columnar_chunk& chunk(size_t index) const { return chunks[index]; }
+    const std::string& component_name(uint32_t id) const { return component_names[id]; }
+    const std::string& port_name(uint32_t id) const { return port_names[id]; }
+
+    /**
+     * Reads the times of a chunk, only the time column is read.
+     * @param index chunk
+     * @param times receives the times in milliseconds
+     * @return false if the column cannot be read
+     */
+    bool read_times(size_t index, std::vector<int64_t> &times);
+
+    /**
+     * Reads the component or the port indexes of a chunk.
+     * @param index chunk
+     * @param column COLUMNAR_COMPONENT or COLUMNAR_PORT
+     * @param ids receives the dictionary indexes
+     * @return false if the column cannot be read
+     */
+    bool read_ids(size_t index, columnar_column column, std::vector<uint32_t> &ids);
+
+    /**
+     * Reads the values of a chunk.
+     * @param index chunk
+     * @param values receives the values, in the integer member of the
+     * records flagged TRACE_INTEGER and in the value member of the others
+     * @return false if the column cannot be read
+     */
+    bool read_values(size_t index, std::vector<trace_record> &values);
+
+    /**
+     * Reads the bag column of a chunk and gives the row of the output
+     * table of every message; the messages of one bag have the same row.
+     * @param index chunk
+     * @param rows receives the rows
+     * @return false if the column cannot be read
+     */
+    bool read_rows(size_t index, std::vector<uint64_t> &rows);
+
+    private:
+    /**
+     * Reads one block and unpacks its numbers.
+     */
+    bool read_numbers(const columnar_chunk &chunk, columnar_column column,
+        std::vector<uint64_t> &numbers);
+
+    FILE *file = nullptr;
+    columnar_header header = {};
+    std::vector<columnar_chunk> chunks;
+    std::vector<std::string> component_names;
+    std::vector<std::string> port_names;
+    std::vector<uint8_t> block;
+    std::vector<uint64_t> numbers;
+};
+
+/**
+ * Writes the columnar file of an output table (output.txt); a row of a bag
+ * with several messages gives one message per value, all in that row.
+ * @param input path of the table
+ * @param output path of the columnar file
+ * @return false if a file cannot be opened
+ */
+
+bool output_to_columnar(const char *input, const char *output);
+
+/**
+ * Writes the columnar file of a binary trace (trace_binary.hpp).
+ * @param input path of the binary trace
+ * @param output path of the columnar file
+ * @return false if a file cannot be opened
+ */
+
+bool trace_to_columnar(const char *input, const char *output);
+
+/**
+ * Writes the table of output_filter from a columnar file, one row per
+ * bag, as trace_to_output does.
+ * @param input path of the columnar file
+ * @param output path of the table
+ * @return false if a file cannot be opened
+ */
+
+bool columnar_to_output(const char *input, const char *output);
+
+#endif // _TRACE_COLUMNAR_HPP_
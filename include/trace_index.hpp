@@ -0,0 +1,89 @@
+/**
+ * \brief side index of the output table for repeated queries.
+ *
+ * The index of output.txt is written next to it as output.txt.idx. The
+ * table is cut into blocks of whole rows (about 64 KB each) and the index
+ * stores, for every block, its offset, its length and its first and last
+ * simulation times, and for every component/port pair, the list of blocks
+ * where it appears. run_queries uses it to only read the blocks that can
+ * hold matching rows, and falls back to a full scan when there is no index
+ * or when the table changed since the index was built.
+ *
+ * The raw log of the message logger (abp_output.txt) is indexed in the
+ * same way, by the component/port pairs of its bags, with blocks that
+ * start on a time line; its index is abp_output.txt.idx.
+ */
+
+#ifndef _TRACE_INDEX_HPP_
+#define _TRACE_INDEX_HPP_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "query.hpp"
+
+/**<rows are grouped in blocks of about this many bytes*/
+static constexpr uint64_t INDEX_BLOCK_BYTES = 1 << 16;
+
+/**
+ * One block of rows of the table.
+ */
+
+struct index_block{
+    uint64_t offset;     /**<offset of the first row in the table*/
+    uint64_t length;     /**<length of the block in bytes*/
+    double time_min;     /**<first simulation time of the block, in seconds*/
+    double time_max;     /**<last simulation time of the block, in seconds*/
+};
+
+/**
+ * Index of one table.
+ */
+
+struct table_index{
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    std::vector<std::string> components;        /**<component of every key*/
+    std::vector<std::string> ports;             /**<port of every key*/
+    std::vector<std::vector<uint32_t>> postings;  /**<blocks of every key*/
+    std::vector<index_block> blocks;
+};
+
+/**
+ * @param table path of the table
+ * @return path of its index
+ */
+
+std::string table_index_path(const char *table);
+
+/**
+ * Reads the whole table once and writes its index.
+ * @param table path of the table or of the raw log
+ * @return false if the table or the index cannot be opened
+ */
+
+bool build_table_index(const char *table);
+
+/**
+ * Loads the index of a table if it exists and is up to date.
+ * @param table path of the table
+ * @param index receives the index
+ * @return false if there is no usable index
+ */
+
+bool load_table_index(const char *table, table_index &index);
+
+/**
+ * Gives the blocks that can hold rows matching at least one predicate of
+ * the groups, in table order.
+ * @param index index of the table
+ * @param groups query groups
+ * @return block numbers
+ */
+
+std::vector<uint32_t> select_index_blocks(const table_index &index,
+    const std::vector<query_group> &groups);
+
+#endif // _TRACE_INDEX_HPP_
@@ -0,0 +1,278 @@
+/**
+ * \brief This code writes the log of the simulation on a background thread.
+ *
+ * The simulation thread gathers the log lines in the put area of the
+ * stream buffer and pushes the complete lines into the ring; the writer
+ * thread writes what is in the ring when there is at least write_size bytes
+ * of it, when the oldest byte waited max_latency_seconds, or when a flush
+ * or the close asks for it. head and tail only grow, the position of a
+ * byte in the ring is its count modulo the capacity.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include "../include/async_log.hpp"
+
+using async_clock = std::chrono::steady_clock;
+
+/**<pushes that only yield before the simulation thread sleeps*/
+static constexpr int ASYNC_LOG_SPINS = 64;
+/**<sleep of the simulation thread waiting for room, and of an idle writer*/
+static constexpr std::chrono::microseconds ASYNC_LOG_SLEEP(20);
+static constexpr std::chrono::microseconds ASYNC_LOG_IDLE(200);
+
+/**
+ * @return seconds between two points of async_clock
+ */
+
+static double seconds_between(async_clock::time_point from,
+    async_clock::time_point to){
+    return std::chrono::duration_cast<std::chrono::duration<double>>(
+        to - from).count();
+}
+
+void async_log_statistics::print(std::ostream &os) const{
+    os << "Async log: " << bytes_written << " bytes in " << writes
+       << " writes, " << lines_dropped << " lines dropped (" << bytes_dropped
+       << " bytes), blocked " << blocked_seconds << "s in " << blocks
+       << " pushes, " << peak_bytes << " bytes in memory at most" << std::endl;
+}
+
+void parse_async_log_policy(const std::string &spec, async_log_config &config){
+    const size_t colon = spec.find(':');
+    const std::string name = spec.substr(0, colon);
+    if(name == "drop" && colon == std::string::npos){
+        config.policy = async_log_policy::drop;
+        config.max_block_seconds = 0;
+    }else if(name == "block"){
+        config.policy = async_log_policy::block;
+        config.max_block_seconds = colon == std::string::npos ? 0 :
+            std::stod(spec.substr(colon + 1));
+        if(config.max_block_seconds < 0){
+            throw std::invalid_argument("negative wait in log policy " + spec);
+        }
+    }else{
+        throw std::invalid_argument("unknown log policy " + spec);
+    }
+}
+
+/**
+ * Writes what is left if close was not called.
+ */
+
+async_log_streambuf::~async_log_streambuf(){
+    close();
+}
+
+bool async_log_streambuf::open(const char *path, const async_log_config &config){
+    close();
+    file = fopen(path, "wb");
+    if(file == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    // the writer already writes in large blocks
+    setvbuf(file, NULL, _IONBF, 0);
+    this->config = config;
+    size_t capacity = 1024;
+    while(capacity < config.capacity){
+        capacity <<= 1;
+    }
+    ring.assign(capacity, '\0');
+    mask = capacity - 1;
+    if(this->config.write_size == 0 || this->config.write_size > capacity / 2){
+        this->config.write_size = capacity / 2;
+    }
+    if(this->config.batch_size == 0){
+        this->config.batch_size = 1;
+    }
+    batch.assign(this->config.batch_size, '\0');
+    setp(batch.data(), batch.data() + batch.size());
+    stats = async_log_statistics();
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    flush_requested.store(false, std::memory_order_relaxed);
+    stopping.store(false, std::memory_order_relaxed);
+    bytes_written = 0;
+    writes = 0;
+    write_failed = false;
+    last_push = async_clock::now();
+    writer = std::thread(&async_log_streambuf::write_loop, this);
+    return true;
+}
+
+void async_log_streambuf::flush(){
+    if(file == NULL){
+        return;
+    }
+    push_batch(false);
+    const uint64_t pushed = head.load(std::memory_order_relaxed);
+    flush_requested.store(true, std::memory_order_release);
+    while(tail.load(std::memory_order_acquire) < pushed){
+        std::this_thread::sleep_for(ASYNC_LOG_SLEEP);
+    }
+    flush_requested.store(false, std::memory_order_release);
+}
+
+void async_log_streambuf::close(){
+    if(file == NULL){
+        return;
+    }
+    push_batch(true);
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    stats.bytes_written = bytes_written;
+    stats.writes = writes;
+    if(write_failed){
+        printf("ERROR in writing file");
+    }
+    fclose(file);
+    file = NULL;
+    setp(nullptr, nullptr);
+}
+
+async_log_streambuf::int_type async_log_streambuf::overflow(int_type c){
+    if(file == NULL){
+        return traits_type::eof();
+    }
+    push_batch(false);
+    if(pptr() == epptr()){
+        // a line longer than the batch is pushed in pieces
+        push_batch(true);
+    }
+    if(c != traits_type::eof()){
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int async_log_streambuf::sync(){
+    if(file != NULL && seconds_between(last_push, async_clock::now()) >=
+        config.max_latency_seconds){
+        push_batch(false);
+    }
+    return 0;
+}
+
+void async_log_streambuf::push_batch(bool all){
+    last_push = async_clock::now();
+    char *begin = pbase();
+    char *end = pptr();
+    char *last = end;
+    if(!all){
+        while(last > begin && last[-1] != '\n'){
+            last--;
+        }
+    }
+    if(last > begin){
+        push(begin, last - begin);
+    }
+    const size_t unfinished = end - last;
+    memmove(batch.data(), last, unfinished);
+    setp(batch.data(), batch.data() + batch.size());
+    pbump(static_cast<int>(unfinished));
+}
+
+void async_log_streambuf::push(const char *data, size_t size){
+    const size_t capacity = ring.size();
+    uint64_t pushed = head.load(std::memory_order_relaxed);
+    bool waited = false;
+    async_clock::time_point wait_start;
+    int spins = 0;
+    while(size > 0){
+        const size_t room = capacity -
+            (pushed - tail.load(std::memory_order_acquire));
+        // whole lines only, unless one line does not fit in the empty ring
+        size_t count = size;
+        if(count > room){
+            count = room;
+            while(count > 0 && data[count - 1] != '\n'){
+                count--;
+            }
+            if(count == 0 && room == capacity){
+                count = room;
+            }
+        }
+        if(count > 0){
+            const size_t position = pushed & mask;
+            const size_t first = count < capacity - position ?
+                count : capacity - position;
+            memcpy(ring.data() + position, data, first);
+            memcpy(ring.data(), data + first, count - first);
+            pushed += count;
+            head.store(pushed, std::memory_order_release);
+            data += count;
+            size -= count;
+            spins = 0;
+            continue;
+        }
+        // the next line does not fit
+        const async_clock::time_point now = async_clock::now();
+        if(!waited){
+            wait_start = now;
+        }
+        if(config.policy == async_log_policy::drop ||
+            (config.max_block_seconds > 0 &&
+            seconds_between(wait_start, now) >= config.max_block_seconds)){
+            stats.bytes_dropped += size;
+            for(size_t i = 0; i < size; i++){
+                stats.lines_dropped += data[i] == '\n' ? 1 : 0;
+            }
+            break;
+        }
+        waited = true;
+        if(spins++ < ASYNC_LOG_SPINS){
+            std::this_thread::yield();
+        }else{
+            std::this_thread::sleep_for(ASYNC_LOG_SLEEP);
+        }
+    }
+    if(waited){
+        stats.blocks++;
+        stats.blocked_seconds += seconds_between(wait_start, async_clock::now());
+    }
+    const uint64_t in_ring = pushed - tail.load(std::memory_order_relaxed);
+    if(in_ring > stats.peak_bytes){
+        stats.peak_bytes = in_ring;
+    }
+}
+
+void async_log_streambuf::write_loop(){
+    const size_t capacity = ring.size();
+    uint64_t written = tail.load(std::memory_order_relaxed);
+    async_clock::time_point last_write = async_clock::now();
+    while(true){
+        const bool stop = stopping.load(std::memory_order_acquire);
+        const uint64_t pushed = head.load(std::memory_order_acquire);
+        const size_t available = pushed - written;
+        if(available > 0 && (available >= config.write_size || stop ||
+            flush_requested.load(std::memory_order_acquire) ||
+            seconds_between(last_write, async_clock::now()) >=
+            config.max_latency_seconds)){
+            const size_t position = written & mask;
+            const size_t first = available < capacity - position ?
+                available : capacity - position;
+            if(!write_failed &&
+                (fwrite(ring.data() + position, 1, first, file) != first ||
+                fwrite(ring.data(), 1, available - first, file) !=
+                available - first)){
+                write_failed = true;
+            }
+            writes += available > first ? 2 : 1;
+            bytes_written += available;
+            written += available;
+            tail.store(written, std::memory_order_release);
+            last_write = async_clock::now();
+            continue;
+        }
+        if(stop && available == 0){
+            break;
+        }
+        std::this_thread::sleep_for(ASYNC_LOG_IDLE);
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * \brief Batch mode: runs every scenario of a scenario file in one process.
+ *
+ * Every line of the scenario file (see scenario.hpp) gives the input file,
+ * the seed, the horizon, the channel, the protocol and the times of the
+ * models of one run. The runs are spread over a pool of threads, each one
+ * logs in memory as replicate_pg does, and one row per scenario is written
+ * to a CSV file, in the order of the scenario file; the fields that hold a
+ * comma (a name, the empirical delay model) are quoted.
+ *
+ * Usage: ./batch_pg scenario_file [--output=PATH] [--threads=N]
+ */
+
+#define BATCH_OUTPUT "../data/batch_results.csv"
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include <stdio.h>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "../../include/message.hpp"
+
+
+#include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/abp_topology.hpp"
+#include "../../include/replication.hpp"
+#include "../../include/scenario.hpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+/*************** Loggers *******************/
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages,
+                   cadmium::dynamic::logger::formatter<TIME>,
+                   replication_sink_provider>;
+using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time,
+                  cadmium::dynamic::logger::formatter<TIME>,
+                  replication_sink_provider>;
+using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+
+/**
+ * Quotes a field of the results when it holds a comma, a quote or a line
+ * break, e.g. a name or the empirical:1,2,3 delay model.
+ * @param text the field
+ * @return the field as written in the CSV file
+ */
+
+static string csv_field(const string &text){
+    if(text.find_first_of(",\"\r\n") == string::npos){
+        return text;
+    }
+    string quoted = "\"";
+    for(char c : text){
+        if(c == '"'){
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+ * Measures of one scenario.
+ */
+
+struct scenario_result{
+    replication_result run;         /**<measures taken from the log*/
+    sender_statistics senders;      /**<filled by the abp senders*/
+    double wall_seconds = 0;        /**<time taken by the run*/
+};
+
+int main(int argc, char ** argv){
+
+    /**<results file*/
+    string output = BATCH_OUTPUT;
+    /**<worker threads, 0 for one per core*/
+    unsigned int threads = 0;
+    /**<positional arguments*/
+    vector<string> arguments;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument.rfind("--output=", 0) == 0) {
+            output = argument.substr(9);
+        } else if (argument.rfind("--threads=", 0) == 0) {
+            threads = atoi(argument.substr(10).c_str());
+        } else {
+            arguments.push_back(argument);
+        }
+    }
+
+    if (arguments.empty()) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the scenario file [--output=PATH]"
+             << " [--threads=N]" << endl;
+        return 1;
+    }
+
+    vector<scenario> scenarios;
+    try {
+        scenarios = read_scenarios(arguments[0].c_str());
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    auto start = hclock::now();
+    vector<scenario_result> results = run_replications(
+        static_cast<int>(scenarios.size()), threads, [&](int index){
+            const scenario &s = scenarios[index];
+            scenario_result result;
+            auto run_start = hclock::now();
+            protocol_config protocol = s.protocol;
+            protocol.statistics = std::make_shared<sender_statistics>();
+            std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
+            make_abp_top<TIME>(s.input.c_str(), s.links, s.seed, s.channel,
+                s.payload_length, protocol);
+
+            replication_log().str("");
+            cadmium::dynamic::engine::runner<TIME, logger_top> r(TOP, {0});
+            r.run_until(std::isinf(s.horizon_seconds) ?
+                std::numeric_limits<TIME>::infinity() :
+                seconds_to_time<TIME>(s.horizon_seconds));
+
+            std::istringstream log(replication_log().str());
+            replication_log().str("");
+            result.run = summarize_replication(log);
+            result.run.seed = s.seed;
+            result.senders = *protocol.statistics;
+            result.wall_seconds = std::chrono::duration_cast<
+                std::chrono::duration<double, std::ratio<1>>>(
+                hclock::now() - run_start).count();
+            return result;
+        });
+    auto simulation_time = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+
+    FILE *fp = fopen(output.c_str(), "w");
+    if (fp == NULL) {
+        printf("ERROR in opening file");
+        return 1;
+    }
+    fprintf(fp, "name,input,seed,links,horizon,protocol,window,rto,delay,loss,"
+        "payload,preparation,timeout,receiver_preparation,packets_sent,"
+        "acks_received,retransmissions,completion_time,throughput,timeouts,"
+        "mean_rtt,wall_seconds\n");
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        const scenario &s = scenarios[i];
+        const scenario_result &r = results[i];
+        fprintf(fp, "%s,%s,%u,%d,%s,%s,%u,%s,%s,%s,%u,%g,%g,%g,%ld,%ld,%ld,"
+            "%.3f,%.6f,%llu,%.4f,%.6f\n", csv_field(s.name).c_str(),
+            csv_field(s.input).c_str(), s.seed, s.links, s.horizon.c_str(),
+            s.protocol.name.c_str(), s.protocol.window,
+            s.protocol.adaptive_timeout ? "adaptive" : "fixed",
+            csv_field(s.channel.delay).c_str(),
+            csv_field(s.channel.loss).c_str(), s.payload_length,
+            s.protocol.sender_preparation, s.protocol.timeout,
+            s.protocol.receiver_preparation, r.run.packets_sent,
+            r.run.acks_received, r.run.retransmissions, r.run.completion_time,
+            r.run.throughput, (unsigned long long)r.senders.timeouts,
+            r.senders.rtt_samples > 0 ?
+            r.senders.rtt_sum / r.senders.rtt_samples : 0.0, r.wall_seconds);
+    }
+    fclose(fp);
+
+    cout << "Scenarios: " << scenarios.size() << ", results: " << output << endl;
+    cout << "Simulation took:" << simulation_time << "sec" << endl;
+    return 0;
+}
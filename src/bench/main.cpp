@@ -0,0 +1,352 @@
+/**
+ * \brief Benchmark suite of the ABP top model.
+ *
+ * This program runs a fixed list of scenarios that vary the number of
+ * packets (10^3 to 10^7), the loss model, the delay model and the number of
+ * links, the payload size and the protocol. The packet scenarios are also run on the static build of
+ * abp_static.hpp, to compare it with the dynamic build of abp_topology.hpp,
+ * and on the dynamic build with the integer tick_time of tick_time.hpp
+ * instead of NDTime (build "dynamic_tick"), so their ns_per_transition
+ * gives the cost of the TIME type in every transition.
+ * Every scenario runs in its own process until the model passivates, and
+ * reports as one JSON object:
+ *
+ *   wall_seconds         time to build the model and run it
+ *   events               simulation steps (distinct event times)
+ *   events_per_second    events / wall_seconds
+ *   transitions          state changes of the atomic models
+ *   ns_per_transition    wall_seconds / transitions, in nanoseconds
+ *   peak_rss_kb          peak resident memory of the scenario
+ *   pool_hits            payloads served from the free lists of the pool
+ *   pool_misses          payloads that needed new memory
+ *   simulated_seconds    simulated time of the last event, when the model
+ *                        passivates after the last acknowledgement
+ *   packets_per_hour     packets / simulated_seconds * 3600
+ *   retransmissions      packets sent again by the abp senders (dynamic
+ *                        build only)
+ *
+ * The protocol scenarios run the same channels with the alternating bit,
+ * Go-Back-N and Selective Repeat models, so their packets_per_hour gives
+ * the throughput gain of a window on that channel. The rto scenarios do
+ * the same for the fixed and the adaptive timeout of the abp Sender.
+ *
+ * Nothing is logged: the logger only counts the state and time entries
+ * the runner would write, so the figures do not include any formatting or
+ * disk I/O.
+ *
+ * Usage: ./bench_pg [--max-packets=N] [--only=TEXT]
+ *
+ *   --max-packets   skips the scenarios with more packets than N
+ *   --only          runs the scenarios whose name contains TEXT
+ */
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "../../include/message.hpp"
+
+
+#include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/tick_time.hpp"
+#include "../../include/abp_topology.hpp"
+#include "../../include/abp_static.hpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+/**
+ * One benchmark scenario.
+ */
+
+struct bench_scenario{
+    string name;
+    long packets;
+    int links;
+    channel_config channel;
+    bool static_build = false;   /**<run abp_static_top, one link only*/
+    uint32_t payload = 0;        /**<payload bytes of every data packet*/
+    string protocol = "abp";     /**<see parse_protocol*/
+    bool adaptive_timeout = false;  /**<adaptive timeout of the abp senders*/
+    bool ticks = false;          /**<dynamic build on tick_time*/
+};
+
+/**
+ * Logger that counts the entries of the runner instead of writing them.
+ * The state of a model is logged once at initialization and after each of
+ * its transitions, and the global time once per simulation step.
+ */
+
+struct bench_counter{
+    static long long transitions;
+    static long long events;
+    static NDTime last_time;     /**<time of the last step of an NDTime run*/
+    static tick_time last_ticks; /**<time of the last step of a tick_time run*/
+
+    template<typename DECLARED_SOURCE, typename INFO, typename... PARAMs>
+    static void log(const PARAMs&... params){
+        if(std::is_same<DECLARED_SOURCE, cadmium::logger::logger_state>::value){
+            transitions++;
+        }else if(std::is_same<DECLARED_SOURCE, cadmium::logger::logger_global_time>::value){
+            events++;
+            record_time(params...);
+        }
+    }
+
+    static void record_time(const NDTime &time){
+        last_time = time;
+    }
+
+    static void record_time(const tick_time &time){
+        last_ticks = time;
+    }
+
+    template<typename... PARAMs>
+    static void record_time(const PARAMs&...){}
+
+    /**
+     * @param ticks the run was on tick_time
+     * @return the time of the last step in seconds, converted once the run
+     * is over rather than at every step
+     */
+    static double last_seconds(bool ticks){
+        return ticks ? time_to_seconds(last_ticks) : time_to_seconds(last_time);
+    }
+};
+
+long long bench_counter::transitions = 0;
+long long bench_counter::events = 0;
+NDTime bench_counter::last_time;
+tick_time bench_counter::last_ticks;
+
+/**
+ * @return the scenarios of the suite
+ */
+
+static vector<bench_scenario> bench_scenarios(){
+    vector<bench_scenario> scenarios;
+    const channel_config base;
+    for(long packets = 1000; packets <= 10000000; packets *= 10){
+        scenarios.push_back({"packets_" + to_string(packets), packets, 1, base});
+        scenarios.push_back({"static_packets_" + to_string(packets), packets, 1,
+            base, true});
+        bench_scenario ticks = {"tick_packets_" + to_string(packets), packets,
+            1, base};
+        ticks.ticks = true;
+        scenarios.push_back(ticks);
+    }
+    const vector<pair<string, string>> losses = {
+        {"loss_none", "bernoulli:0"},
+        {"loss_20", "bernoulli:0.2"},
+        {"loss_gilbert", "gilbert:0.01:0.1:0:0.5"}
+    };
+    for(const auto &loss : losses){
+        channel_config channel = base;
+        channel.loss = loss.second;
+        scenarios.push_back({loss.first, 10000, 1, channel});
+    }
+    const vector<pair<string, string>> delays = {
+        {"delay_exponential", "exponential:3"},
+        {"delay_uniform", "uniform:1:5"},
+        {"delay_empirical", "empirical:1,2,3,5,8"}
+    };
+    for(const auto &delay : delays){
+        channel_config channel = base;
+        channel.delay = delay.second;
+        scenarios.push_back({delay.first, 10000, 1, channel});
+    }
+    for(uint32_t payload : {1500u, 65536u, 1048576u}){
+        bench_scenario scenario = {"payload_" + to_string(payload), 10000, 1, base};
+        scenario.payload = payload;
+        scenarios.push_back(scenario);
+    }
+    for(const char *loss : {"bernoulli:0.05", "bernoulli:0.2"}){
+        for(const char *protocol : {"abp", "gbn:8", "sr:8"}){
+            channel_config channel = base;
+            channel.loss = loss;
+            string name = string("protocol_") + protocol + "_" + loss;
+            replace(name.begin(), name.end(), ':', '_');
+            bench_scenario scenario = {name, 10000, 1, channel};
+            scenario.protocol = protocol;
+            scenarios.push_back(scenario);
+        }
+    }
+    for(const char *delay : {"normal:3:1", "exponential:3", "uniform:20:30"}){
+        for(bool adaptive : {false, true}){
+            channel_config channel = base;
+            channel.delay = delay;
+            string name = string(adaptive ? "rto_adaptive_" : "rto_fixed_") + delay;
+            replace(name.begin(), name.end(), ':', '_');
+            bench_scenario scenario = {name, 10000, 1, channel};
+            scenario.adaptive_timeout = adaptive;
+            scenarios.push_back(scenario);
+        }
+    }
+    for(int links = 4; links <= 64; links *= 4){
+        scenarios.push_back({"links_" + to_string(links), 1000, links, base});
+        bench_scenario ticks = {"tick_links_" + to_string(links), 1000, links,
+            base};
+        ticks.ticks = true;
+        scenarios.push_back(ticks);
+    }
+    return scenarios;
+}
+
+/**
+ * Runs a scenario on the dynamic build until the model passivates.
+ * @param scenario
+ * @param input control input file
+ * @param statistics filled by the abp senders
+ */
+
+template<typename T>
+static void run_dynamic_build(const bench_scenario &scenario, const char *input,
+    const std::shared_ptr<sender_statistics> &statistics){
+    protocol_config protocol = parse_protocol(scenario.protocol);
+    protocol.adaptive_timeout = scenario.adaptive_timeout;
+    protocol.statistics = statistics;
+    std::shared_ptr<cadmium::dynamic::modeling::coupled<T>> TOP =
+    make_abp_top<T>(input, scenario.links, 1, scenario.channel,
+        scenario.payload, protocol);
+    cadmium::dynamic::engine::runner<T, bench_counter> r(TOP, T({0}));
+    r.run_until(std::numeric_limits<T>::infinity());
+}
+
+/**
+ * Runs one scenario in the current process and prints its JSON object.
+ * @param scenario
+ * @return exit code of the scenario process
+ */
+
+static int run_bench_scenario(const bench_scenario &scenario){
+
+    char input[] = "/tmp/abp_bench_XXXXXX";
+    int fd = mkstemp(input);
+    if(fd < 0){
+        printf("ERROR in opening file");
+        return 1;
+    }
+    FILE *fp = fdopen(fd, "w");
+    fprintf(fp, "00:00:10 %ld\n", scenario.packets);
+    fclose(fp);
+
+    std::shared_ptr<sender_statistics> statistics =
+        std::make_shared<sender_statistics>();
+    auto start = hclock::now();
+    if(scenario.static_build){
+        abp_static_config().input = input;
+        abp_static_config().seed = 1;
+        abp_static_config().channel = scenario.channel;
+        cadmium::engine::runner<TIME, abp_static_top, bench_counter> r{TIME({0})};
+        r.runUntil(std::numeric_limits<TIME>::infinity());
+    }else if(scenario.ticks){
+        run_dynamic_build<tick_time>(scenario, input, statistics);
+    }else{
+        run_dynamic_build<TIME>(scenario, input, statistics);
+    }
+    double wall_seconds = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+    unlink(input);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    const long long transitions = bench_counter::transitions;
+    const long long events = bench_counter::events;
+    const double simulated_seconds = bench_counter::last_seconds(scenario.ticks);
+    printf("  {\"name\": \"%s\", \"build\": \"%s\", \"packets\": %ld, \"links\": %d, "
+        "\"delay\": \"%s\", \"loss\": \"%s\", \"wall_seconds\": %.6f, "
+        "\"events\": %lld, \"events_per_second\": %.1f, "
+        "\"transitions\": %lld, \"ns_per_transition\": %.2f, "
+        "\"peak_rss_kb\": %ld, \"payload\": %u, \"pool_hits\": %llu, "
+        "\"pool_misses\": %llu, \"protocol\": \"%s\", "
+        "\"simulated_seconds\": %.3f, \"packets_per_hour\": %.2f, "
+        "\"timeout\": \"%s\", \"retransmissions\": %llu}",
+        scenario.name.c_str(), scenario.static_build ? "static" :
+        scenario.ticks ? "dynamic_tick" : "dynamic",
+        scenario.packets, scenario.links,
+        scenario.channel.delay.c_str(), scenario.channel.loss.c_str(),
+        wall_seconds, events, wall_seconds > 0 ? events / wall_seconds : 0.0,
+        transitions, transitions > 0 ? wall_seconds * 1e9 / transitions : 0.0,
+        usage.ru_maxrss, scenario.payload,
+        static_cast<unsigned long long>(payload_pool::local().statistics().hits),
+        static_cast<unsigned long long>(payload_pool::local().statistics().misses),
+        scenario.protocol.c_str(), simulated_seconds,
+        simulated_seconds > 0 ?
+        scenario.packets * scenario.links * 3600.0 / simulated_seconds : 0.0,
+        scenario.adaptive_timeout ? "adaptive" : "fixed",
+        static_cast<unsigned long long>(statistics->retransmissions));
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char ** argv){
+
+    /**<scenarios with more packets are skipped*/
+    long max_packets = 10000000;
+    /**<only the scenarios whose name contains this text are run*/
+    string only;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument.rfind("--max-packets=", 0) == 0) {
+            max_packets = atol(argument.substr(14).c_str());
+        } else if (argument.rfind("--only=", 0) == 0) {
+            only = argument.substr(7);
+        } else {
+            cout << "you are using this program with wrong parameters.";
+            cout << "The program should be invoked as follow:";
+            cout << argv[0] << " [--max-packets=N] [--only=TEXT]" << endl;
+            return 1;
+        }
+    }
+
+    printf("[\n");
+    bool first = true;
+    int failures = 0;
+    for (const bench_scenario &scenario : bench_scenarios()) {
+        if (scenario.packets > max_packets ||
+            scenario.name.find(only) == string::npos) {
+            continue;
+        }
+        if (!first) {
+            printf(",\n");
+        }
+        first = false;
+        fflush(stdout);
+
+        // every scenario in its own process, so that peak_rss_kb is its own
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(run_bench_scenario(scenario));
+        }
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("  {\"name\": \"%s\", \"error\": true}", scenario.name.c_str());
+            failures++;
+        }
+    }
+    printf("\n]\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,222 @@
+/**
+ * \brief This program exports an output table to the columnar format and
+ * reads the columns back.
+ *
+ * The export is written from output.txt, or from a binary trace of main_pg
+ * (--trace=binary) with --trace. With --column, one column of a columnar
+ * file is printed, one value per line: only that column is read and
+ * decoded, and with --from/--to the chunks outside the time range are
+ * skipped from their statistics. The row column gives the row of the
+ * output table of every message, the messages of one bag share it. --chunks prints the directory and
+ * --to-text writes the output table again.
+ *
+ * Usage: ./columnar_export path_to_output_table path_to_columnar_file
+ *        ./columnar_export --trace path_to_binary_trace path_to_columnar_file
+ *        ./columnar_export --column=time|component|port|value|row
+ *            [--from=HH:MM:SS:mmm] [--to=HH:MM:SS:mmm] path_to_columnar_file
+ *        ./columnar_export --chunks path_to_columnar_file
+ *        ./columnar_export --to-text path_to_columnar_file path_to_output_table
+ *
+ * Example:
+ *   ./columnar_export ../data/output.txt ../data/output.col
+ *   ./columnar_export --column=value --from=00:10:00:000 ../data/output.col
+ */
+
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../text_filter.cpp"
+#include "../query.cpp"
+#include "../trace_index.cpp"
+#include "../trace_binary.cpp"
+#include "../trace_columnar.cpp"
+
+using namespace std;
+
+/**
+ * Prints one column of the chunks that can hold rows between from and to.
+ * The time column is only read for the chunks that are partly in the range.
+ * @param reader
+ * @param column
+ * @param from first time in milliseconds
+ * @param to last time in milliseconds
+ * @return false if a column cannot be read
+ */
+
+static bool print_column(columnar_reader &reader, columnar_column column,
+    int64_t from, int64_t to){
+
+    vector<int64_t> times;
+    vector<uint32_t> ids;
+    vector<trace_record> values;
+    vector<uint64_t> rows;
+    char text[64];
+    long skipped = 0;
+    for (size_t c = 0; c < reader.chunk_count(); c++) {
+        const columnar_chunk &chunk = reader.chunk(c);
+        if (chunk.time_max < from || chunk.time_min > to) {
+            skipped++;
+            continue;
+        }
+        const bool whole = chunk.time_min >= from && chunk.time_max <= to;
+        if ((column == COLUMNAR_TIME || !whole) && !reader.read_times(c, times)) {
+            return false;
+        }
+        if ((column == COLUMNAR_COMPONENT || column == COLUMNAR_PORT) &&
+            !reader.read_ids(c, column, ids)) {
+            return false;
+        }
+        if (column == COLUMNAR_VALUE && !reader.read_values(c, values)) {
+            return false;
+        }
+        if (column == COLUMNAR_BAG && !reader.read_rows(c, rows)) {
+            return false;
+        }
+        for (size_t i = 0; i < chunk.rows; i++) {
+            if (!whole && (times[i] < from || times[i] > to)) {
+                continue;
+            }
+            switch (column) {
+            case COLUMNAR_TIME:
+                format_trace_time(times[i], text);
+                puts(text);
+                break;
+            case COLUMNAR_COMPONENT:
+                puts(reader.component_name(ids[i]).c_str());
+                break;
+            case COLUMNAR_PORT:
+                puts(reader.port_name(ids[i]).c_str());
+                break;
+            case COLUMNAR_VALUE:
+                format_trace_value(values[i], text);
+                puts(text);
+                break;
+            default:
+                printf("%llu\n", static_cast<unsigned long long>(rows[i]));
+                break;
+            }
+        }
+    }
+    cerr << skipped << " of " << reader.chunk_count()
+         << " chunks skipped" << endl;
+    return true;
+}
+
+int main(int argc, char ** argv){
+
+    /**<input is a binary trace*/
+    bool from_trace = false;
+    /**<column to print, empty to export*/
+    string column;
+    /**<print the chunk directory*/
+    bool chunks = false;
+    /**<write the output table from a columnar file*/
+    bool to_text = false;
+    /**<time range of --column, in milliseconds*/
+    int64_t from = numeric_limits<int64_t>::min();
+    int64_t to = numeric_limits<int64_t>::max();
+    /**<positional arguments*/
+    vector<string> arguments;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        if (argument == "--trace") {
+            from_trace = true;
+        } else if (argument.rfind("--column=", 0) == 0) {
+            column = argument.substr(9);
+        } else if (argument == "--chunks") {
+            chunks = true;
+        } else if (argument == "--to-text") {
+            to_text = true;
+        } else if (argument.rfind("--from=", 0) == 0) {
+            from = log_time_to_milliseconds(argument.substr(7));
+        } else if (argument.rfind("--to=", 0) == 0) {
+            to = log_time_to_milliseconds(argument.substr(5));
+        } else {
+            arguments.push_back(argument);
+        }
+    }
+
+    const size_t needed = column.empty() && !chunks ? 2 : 1;
+    if (arguments.size() < needed) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " [--trace] path to the output table or binary trace,"
+             << " path to the columnar file" << endl;
+        cout << argv[0] << " --column=time|component|port|value|row"
+             << " [--from=HH:MM:SS:mmm] [--to=HH:MM:SS:mmm]"
+             << " path to the columnar file" << endl;
+        cout << argv[0] << " --chunks path to the columnar file" << endl;
+        cout << argv[0] << " --to-text path to the columnar file,"
+             << " path to the output table" << endl;
+        return 1;
+    }
+
+    if (to_text) {
+        return columnar_to_output(arguments[0].c_str(),
+            arguments[1].c_str()) ? 0 : 1;
+    }
+    if (column.empty() && !chunks) {
+        if (!(from_trace ?
+            trace_to_columnar(arguments[0].c_str(), arguments[1].c_str()) :
+            output_to_columnar(arguments[0].c_str(), arguments[1].c_str()))) {
+            return 1;
+        }
+        columnar_reader reader;
+        if (!reader.open(arguments[1].c_str())) {
+            return 1;
+        }
+        cout << arguments[1] << ": " << reader.size() << " messages in "
+             << reader.chunk_count() << " chunks" << endl;
+        return 0;
+    }
+
+    columnar_reader reader;
+    if (!reader.open(arguments[0].c_str())) {
+        return 1;
+    }
+    if (chunks) {
+        static const char *names[COLUMNAR_COLUMNS] = {
+            "time", "component", "port", "value", "bag"
+        };
+        char first[32], last[32];
+        for (size_t c = 0; c < reader.chunk_count(); c++) {
+            const columnar_chunk &chunk = reader.chunk(c);
+            format_trace_time(chunk.time_min, first);
+            format_trace_time(chunk.time_max, last);
+            cout << "chunk " << c << ": " << chunk.rows << " rows from row "
+                 << chunk.first_row << ", time " << first << ".." << last << ", value " << chunk.value_min
+                 << ".." << chunk.value_max << endl;
+            for (uint32_t k = 0; k < COLUMNAR_COLUMNS; k++) {
+                cout << "    " << names[k] << ": "
+                     << chunk.columns[k].size << " bytes, "
+                     << static_cast<int>(chunk.columns[k].bit_width)
+                     << " bits per row" << endl;
+            }
+        }
+        return 0;
+    }
+
+    columnar_column selected;
+    if (column == "time") {
+        selected = COLUMNAR_TIME;
+    } else if (column == "component") {
+        selected = COLUMNAR_COMPONENT;
+    } else if (column == "port") {
+        selected = COLUMNAR_PORT;
+    } else if (column == "value") {
+        selected = COLUMNAR_VALUE;
+    } else if (column == "row") {
+        selected = COLUMNAR_BAG;
+    } else {
+        cout << "unknown column " << column << endl;
+        return 1;
+    }
+    if (!print_column(reader, selected, from, to)) {
+        printf("ERROR in reading file");
+        return 1;
+    }
+    return 0;
+}
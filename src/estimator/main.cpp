@@ -0,0 +1,221 @@
+/**
+ * \brief Analytic throughput estimate of the ABP link, with a validation mode.
+ *
+ * This program prints the expected completion time, throughput and
+ * retransmissions of a transfer of PACKETS packets on one link, computed by
+ * abp_estimator.hpp without running the simulation. Sweeps can call it for
+ * every point and only simulate the points worth a closer look.
+ *
+ * With --validate=N the same transfer is also simulated N times on the top
+ * model (as replicate_pg does), and every estimate is printed next to the
+ * mean of the replications, its 95% confidence interval and the relative
+ * error of the estimate.
+ *
+ * Usage: ./estimate_pg packets [--delay=MODEL] [--loss=MODEL]
+ *        [--preparation=S] [--timeout=S] [--receiver-preparation=S]
+ *        [--validate=REPLICATIONS] [--threads=N]
+ *
+ * The times default to the constants of Sender and Receiver. They can be
+ * changed for what-if questions, the validation runs then use the same
+ * times (protocol_config of abp_topology.hpp).
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "../../include/message.hpp"
+
+
+#include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/abp_topology.hpp"
+#include "../../include/replication.hpp"
+#include "../../include/abp_estimator.hpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+/*************** Loggers *******************/
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages,
+                   cadmium::dynamic::logger::formatter<TIME>,
+                   replication_sink_provider>;
+using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time,
+                  cadmium::dynamic::logger::formatter<TIME>,
+                  replication_sink_provider>;
+using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+
+/**<time of the control message of the validation runs*/
+#define VALIDATION_START "00:00:10"
+
+/**
+ * Prints one measure of the validation.
+ * @param name
+ * @param estimate analytic value
+ * @param simulated mean and confidence interval of the replications
+ */
+
+static void print_validation_row(const char *name, double estimate,
+    const interval_estimate &simulated){
+    const double error = simulated.mean != 0 ?
+        (estimate - simulated.mean) / simulated.mean : 0;
+    const bool inside = fabs(estimate - simulated.mean) <= simulated.half_width;
+    printf("%-24s %14.4f %14.4f +/- %-12.4f %+8.2f%%  %s\n", name, estimate,
+        simulated.mean, simulated.half_width, 100 * error,
+        inside ? "inside CI" : "outside CI");
+}
+
+int main(int argc, char ** argv){
+
+    abp_estimate_params params;
+    {
+        // the times of the models themselves
+        Sender<TIME> sender;
+        Receiver<TIME> receiver;
+        params.sender_preparation = time_to_seconds(sender.PREPARATION_TIME);
+        params.timeout = time_to_seconds(sender.timeout);
+        params.receiver_preparation = time_to_seconds(receiver.PREPARATION_TIME);
+    }
+    /**<replications of the validation, 0 for none*/
+    int replications = 0;
+    /**<worker threads of the validation, 0 for one per core*/
+    unsigned int threads = 0;
+    /**<positional arguments*/
+    vector<string> arguments;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        try {
+            if (argument.rfind("--delay=", 0) == 0) {
+                params.channel.delay = argument.substr(8);
+            } else if (argument.rfind("--loss=", 0) == 0) {
+                params.channel.loss = argument.substr(7);
+            } else if (argument.rfind("--preparation=", 0) == 0) {
+                params.sender_preparation = stod(argument.substr(14));
+            } else if (argument.rfind("--timeout=", 0) == 0) {
+                params.timeout = stod(argument.substr(10));
+            } else if (argument.rfind("--receiver-preparation=", 0) == 0) {
+                params.receiver_preparation = stod(argument.substr(23));
+            } else if (argument.rfind("--validate=", 0) == 0) {
+                replications = atoi(argument.substr(11).c_str());
+            } else if (argument.rfind("--threads=", 0) == 0) {
+                threads = atoi(argument.substr(10).c_str());
+            } else {
+                arguments.push_back(argument);
+            }
+        } catch (const std::exception &e) {
+            cout << "wrong argument " << argument << ": " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (arguments.empty() || atol(arguments[0].c_str()) < 1) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " number of packets [--delay=MODEL] [--loss=MODEL]"
+             << " [--preparation=S] [--timeout=S] [--receiver-preparation=S]"
+             << " [--validate=REPLICATIONS] [--threads=N]" << endl;
+        return 1;
+    }
+    try {
+        // the channel models are built once here, so a wrong model is
+        // reported before the simulation starts
+        channel_model check(params.channel);
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    params.packets = atol(arguments[0].c_str());
+    if (replications > 0) {
+        params.start = time_to_seconds(TIME(VALIDATION_START));
+    }
+
+    auto start = hclock::now();
+    const abp_estimate estimate = estimate_abp(params);
+    auto estimate_time = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+
+    printf("loss per subnet:         %.6f\n", estimate.loss);
+    printf("copy acknowledged:       %.6f\n", estimate.success);
+    printf("mean round trip (s):     %.4f\n", estimate.mean_rtt);
+    printf("copies per packet:       %.6f\n", estimate.copies);
+    printf("time per packet (s):     %.4f\n", estimate.cycle);
+    printf("packets per hour:        %.4f\n",
+        estimate.cycle > 0 ? 3600 / estimate.cycle : 0.0);
+    printf("completion time (s):     %.4f\n", estimate.completion_time);
+    printf("throughput (packets/s):  %.6f\n", estimate.throughput);
+    printf("retransmissions:         %.4f\n", estimate.retransmissions);
+    printf("Estimate took:%fsec\n", estimate_time);
+
+    if (replications < 1) {
+        return 0;
+    }
+
+    char input[] = "/tmp/abp_estimate_XXXXXX";
+    int fd = mkstemp(input);
+    if (fd < 0) {
+        printf("ERROR in opening file");
+        return 1;
+    }
+    FILE *fp = fdopen(fd, "w");
+    fprintf(fp, "%s %ld\n", VALIDATION_START, params.packets);
+    fclose(fp);
+
+    protocol_config protocol;
+    protocol.sender_preparation = params.sender_preparation;
+    protocol.timeout = params.timeout;
+    protocol.receiver_preparation = params.receiver_preparation;
+
+    start = hclock::now();
+    vector<replication_result> results = run_replications(replications, threads,
+        [&](int replication){
+            const unsigned int seed = replication + 1;
+            std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
+            make_abp_top<TIME>(input, 1, seed, params.channel, 0, protocol);
+
+            replication_log().str("");
+            cadmium::dynamic::engine::runner<TIME, logger_top> r(TOP, {0});
+            r.run_until(std::numeric_limits<TIME>::infinity());
+
+            std::istringstream log(replication_log().str());
+            replication_log().str("");
+            replication_result result = summarize_replication(log);
+            result.seed = seed;
+            return result;
+        });
+    auto simulation_time = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+    unlink(input);
+
+    vector<double> throughput, retransmissions, completion_time;
+    for (const replication_result &result : results) {
+        throughput.push_back(result.throughput);
+        retransmissions.push_back(static_cast<double>(result.retransmissions));
+        completion_time.push_back(result.completion_time);
+    }
+    printf("\nValidation on %d replications\n", replications);
+    printf("%-24s %14s %14s\n", "measure", "estimate", "simulation");
+    print_validation_row("throughput (packets/s)", estimate.throughput,
+        estimate_interval(throughput));
+    print_validation_row("retransmissions", estimate.retransmissions,
+        estimate_interval(retransmissions));
+    print_validation_row("completion time (s)", estimate.completion_time,
+        estimate_interval(completion_time));
+    printf("Simulation took:%fsec\n", simulation_time);
+    return 0;
+}
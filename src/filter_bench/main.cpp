@@ -0,0 +1,90 @@
+/**
+ * \brief This program measures the throughput of the output filters.
+ *
+ * The log given as input is copied SCALE times (1000 by default) into a
+ * large log, then output_filter and output_filter_mmap are both run on it.
+ * The throughput of each one is printed in MB/s of log read, and the
+ * tables they write are compared.
+ *
+ * Usage: ./filter_bench path_to_log [scale] [work_directory]
+ */
+
+/**<throughput expected from output_filter_mmap on a warm page cache*/
+#define FILTER_TARGET_MBPS 500.0
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+
+#include "../text_filter.cpp"
+#include "../fast_filter.cpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+
+/**
+ * Runs one filter and gives its throughput.
+ * @param filter the filter to run
+ * @param input scaled log
+ * @param output table to write
+ * @param megabytes size of the scaled log
+ * @return throughput in MB/s
+ */
+
+static double measure(void (*filter)(const char*, const char*),
+    const char *input, const char *output, double megabytes){
+    auto start = hclock::now();
+    filter(input, output);
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double,
+                     std::ratio<1>>>(hclock::now() - start).count();
+    return megabytes / seconds;
+}
+
+int main(int argc, char ** argv){
+
+    if (argc < 2) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the log file [scale] [work directory]"
+             << endl;
+        return 1;
+    }
+    const int scale = argc > 2 ? atoi(argv[2]) : 1000;
+    const string directory = argc > 3 ? argv[3] : "/tmp";
+    const string scaled_log = directory + "/filter_bench_log.txt";
+    const string old_table = directory + "/filter_bench_output_filter.txt";
+    const string new_table = directory + "/filter_bench_output_filter_mmap.txt";
+
+    ifstream in(argv[1], ios::binary);
+    string log((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    {
+        ofstream out(scaled_log, ios::binary);
+        for (int i = 0; i < scale; i++) {
+            out << log;
+        }
+    }
+    const double megabytes = static_cast<double>(log.size()) * scale / 1e6;
+
+    // warm the page cache so both filters read from memory
+    measure(output_filter_mmap, scaled_log.c_str(), new_table.c_str(), megabytes);
+
+    double old_mbps = measure(output_filter, scaled_log.c_str(),
+        old_table.c_str(), megabytes);
+    double new_mbps = measure(output_filter_mmap, scaled_log.c_str(),
+        new_table.c_str(), megabytes);
+
+    ifstream old_in(old_table, ios::binary), new_in(new_table, ios::binary);
+    bool same = equal(istreambuf_iterator<char>(old_in), istreambuf_iterator<char>(),
+        istreambuf_iterator<char>(new_in), istreambuf_iterator<char>());
+
+    cout << "Log size: " << megabytes << " MB" << endl;
+    cout << "output_filter: " << old_mbps << " MB/s" << endl;
+    cout << "output_filter_mmap: " << new_mbps << " MB/s (target "
+         << FILTER_TARGET_MBPS << " MB/s, "
+         << (new_mbps >= FILTER_TARGET_MBPS ? "met" : "NOT met") << ")" << endl;
+    cout << "Same table: " << (same ? "yes" : "no") << endl;
+
+    remove(scaled_log.c_str());
+    return same ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+/**
+ * \brief This program writes the side index of an output table.
+ *
+ * The index is written next to the table (output.txt.idx) and is then used
+ * by limit_output and query_output to only read the parts of the table
+ * that can hold matching rows. It has to be built again when the table
+ * changes; a stale index is ignored. A raw log of the simulator
+ * (abp_output.txt) can be indexed and queried in the same way.
+ *
+ * Usage: ./index_output path_to_output_table [path_to_output_table ...]
+ *
+ * Example:
+ *   ./index_output ../data/output.txt ../data/abp_output_0.txt
+ */
+
+#include <iostream>
+
+#include "../text_filter.cpp"
+#include "../query.cpp"
+#include "../trace_index.cpp"
+
+using namespace std;
+
+int main(int argc, char ** argv){
+
+    if (argc < 2) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the output table" << endl;
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (!build_table_index(argv[i])) {
+            return 1;
+        }
+        table_index index;
+        load_table_index(argv[i], index);
+        cout << table_index_path(argv[i]) << ": " << index.blocks.size()
+             << " blocks, " << index.postings.size() << " component/port pairs"
+             << endl;
+    }
+    return 0;
+}
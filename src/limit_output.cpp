@@ -18,6 +18,9 @@
  *  If the structure member values and input file output values are not same
  *  then, the new output file will be empty with a message
  *  "THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE"
+ *
+ *  The rows are selected by the query engine of query.cpp, which can also
+ *  be used directly to select rows by time and value ranges.
  */
 
 #include <stdio.h>
@@ -27,22 +30,22 @@
 #include <fstream>
 #include <iomanip>
 #include <stdarg.h>
+#include <vector>
 
 #include "../include/limit.hpp"
+#include "../include/query.hpp"
 
 
 /**
  * This function takes the input file and output file and a variable number of
- * inputs. Here, we takes a structure variable as input and iterate through file and
- * filter the output accordingly.This function uses concept of ellipsis.
- * The function filters the output based on the structure members, which is
- * initialized in the main cpp files. We pass a structure variable to this
- * function as a variable parameter which is used to get the structure member
- * values and to compare with the input file and write to new file if and only
- * if the structure member values are equal to port and component value of the
- * input file.
- * The function uses pattern matching in the input file to get the string and to
- * compare with the structure members.
+ * inputs. Here, we take k structure variables as input and iterate through the
+ * file and filter the output accordingly. This function uses concept of ellipsis.
+ * The function filters the output based on the structure members, which are
+ * initialized in the main cpp files. A line of the input file is written to the
+ * new file if and only if its port and component are equal to the port and
+ * component of one of the structure variables.
+ * The k structure variables are turned into predicates of one query group, so
+ * the input file is read only once whatever the value of k.
  * @param input
  * @param output
  * @param k
@@ -50,126 +53,27 @@
 
 void limit_output(const char *input, const char *output,int k,...){
 
-    /**<opening file pointers to do file operations*/
-    FILE *fp;
-    FILE *op;
-
-
-    int i,j,counter,check;
-    counter = 1;
-    check = 0;
     /**<creating variable list*/
     va_list c1;
 
     /**<associate new variable with parameter list*/
     va_start(c1,k);
-    const auto c = va_arg(c1,compare);
-
-    /**<variables used to compare the strings*/
-    int result1,result2,result;
-
-    /**<variables to store file content, ie port and component*/
-    char port[500],component[500];
 
-    /**<to store the file line by line data*/
-    char data[500];
-
-    /**<opening the file in read and write mode*/
-
-    fp = fopen(input,"r");
-    op = fopen(output,"w");
-
-
-    if(op == NULL){
-        printf("ERROR in opening file");
-    }
-    char first_line[500] = "TIME\t\tVALUE\t\t\tPORT\t\tCOMPONENT\n";
-    fputs(first_line, op);
-    if(fp == NULL){
-        printf("ERROR in opening file");
+    std::vector<query_group> groups(1);
+    groups[0].output = output;
+    for(int i = 0; i < k; i++){
+        const auto c = va_arg(c1,compare);
+        query_predicate predicate;
+        predicate.port = c.port1;
+        predicate.component = c.component1;
+        groups[0].predicates.push_back(predicate);
     }
 
-    /**
-     * This while loop reads the file line by line and do the operations.
-     */
-    while(fgets(data,500,fp)!= NULL){
-    	check++;
-        /**
-         * This if loop check whether line read has "00:" string, then only the
-         * following statements execute.
-         */
-        if((strstr(data,"00:"))!= NULL){
-
-            /**
-             * reading he value for component from the file
-             */
-            if(strstr(data,"generator_ack")){
-                strcpy(component,"generator_ack");
-            }
-            else if(strstr(data,"receiver1")){
-                strcpy(component,"receiver1");
-            }
-            else if(strstr(data,"sender1")){
-                strcpy(component,"sender1");
-            }
-            else if(strstr(data,"subnet1")){
-                strcpy(component,"subnet1");
-            }
-            else if(strstr(data,"subnet2")){
-                strcpy(component,"subnet2");
-            }
-            else if (strstr(data,"generator_con")){
-                strcpy(component,"generator_con");
-            }
-            else if (strstr(data,"generator")){
-                strcpy(component,"generator");
-            }
-
-            /**
-             * reading the value for port from the file.
-             */
-            if(strstr(data,"output")){
-                strcpy(port,"output");
-            }
-            else if(strstr(data,"data_")){
-                strcpy(port,"data_out");
-            }
-            else if(strstr(data,"pack")){
-                strcpy(port,"packet_sent_out");
-            }
-            else if(strstr(data,"ack")){
-                strcpy(port,"ack_received_out");
-            }
-            else if(strstr(data,"out")){
-                strcpy(port,"out");
-            }
-
-            /**
-             * comparing the port and component with the values sored in structure
-             */
-            result1 = strcmp(c.port1,port);
-            result2 = strcmp(c.component1,component);
-            result = result1+result2;
-
-            /**
-             * checks whether the values are equal with structure elements and write to file.
-             */
-            if(result == 0){
+    /**<closing the va_list*/
+    va_end(c1);
 
-                fprintf(op,data);
-            }
-            else{
-            	counter = counter+1;
-            }
-        }
-    }
-    if(counter >= check){
+    run_queries(input, groups);
+    if(groups[0].matches == 0){
         printf("THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE");
-    	fprintf(op,"THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE");
     }
-    /**<closing the va_list*/
-    va_end(c1);
-    /**< closing the file*/
-    fclose(fp);
-    fclose(op);
 }
@@ -1,6 +1,7 @@
 #include "../../include/message.hpp"
 
 #include <math.h> 
+#include <charconv>
 #include <assert.h>
 #include <iostream>
 #include <fstream>
@@ -12,7 +13,10 @@
 /***************************************************/
 
 ostream& operator<<(ostream& os, const message_t& msg) {
-  os << msg.value;
+  char text[24];
+  std::to_chars_result written = std::to_chars(text, text + sizeof(text),
+    msg.value);
+  os.write(text, written.ptr - text);
   return os;
 }
 
@@ -24,3 +28,13 @@ istream& operator>> (istream& is, message_t& msg) {
   is >> msg.value;
   return is;
 }
+
+/***************************************************/
+/************* Input parsing ***********************/
+/***************************************************/
+
+bool parse_input_value(std::string_view text, message_t& msg) {
+  const char* last = text.data() + text.size();
+  std::from_chars_result parsed = std::from_chars(text.data(), last, msg.value);
+  return parsed.ec == std::errc();
+}
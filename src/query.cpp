@@ -0,0 +1,322 @@
+/**
+ * \brief This code evaluates query groups on the output table in one pass.
+ *
+ * Every row of output.txt is split once into time, value, port and
+ * component. The groups and predicates that accept the component/port pair
+ * of a row are looked up in a cache filled the first time the pair is
+ * seen, then only the time and value ranges are checked for each row.
+ * When the table has a side index, the other blocks are skipped. A raw
+ * log is split bag by bag with for_each_port_value instead, and its
+ * matching rows are formatted as output_filter writes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "../include/query.hpp"
+#include "../include/trace_index.hpp"
+#include "../include/filter.hpp"
+#include "../include/log_parser.hpp"
+
+/**
+ * Reads a time given in seconds or as hh:mm:ss:mmm.
+ * @param text
+ * @return time in seconds
+ */
+
+static double parse_query_time(const std::string &text){
+    if(text.find(':') != std::string::npos){
+        return log_time_to_seconds(text);
+    }
+    return strtod(text.c_str(), NULL);
+}
+
+/**
+ * Reads a range "min..max", either bound can be left empty.
+ * @param text
+ * @param min
+ * @param max
+ * @param is_time true for a time range
+ */
+
+static void parse_query_range(const std::string &text, double &min, double &max,
+    bool is_time){
+    size_t dots = text.find("..");
+    std::string low = dots == std::string::npos ? text : text.substr(0, dots);
+    std::string high = dots == std::string::npos ? text : text.substr(dots + 2);
+    if(!low.empty()){
+        min = is_time ? parse_query_time(low) : strtod(low.c_str(), NULL);
+    }
+    if(!high.empty()){
+        max = is_time ? parse_query_time(high) : strtod(high.c_str(), NULL);
+    }
+}
+
+/**
+ * Reads a group written in its text form.
+ * @param text
+ * @param output
+ * @return the group
+ */
+
+query_group parse_query_group(const std::string &text, const std::string &output){
+    query_group group;
+    group.output = output;
+    std::istringstream predicates(text);
+    std::string predicate_text;
+    while(std::getline(predicates, predicate_text, '|')){
+        query_predicate predicate;
+        std::istringstream fields(predicate_text);
+        std::string field;
+        while(std::getline(fields, field, ';')){
+            size_t equal = field.find('=');
+            if(equal == std::string::npos){
+                continue;
+            }
+            std::string name = field.substr(0, equal);
+            std::string value = field.substr(equal + 1);
+            if(name == "component"){
+                predicate.component = value;
+            }else if(name == "port"){
+                predicate.port = value;
+            }else if(name == "time"){
+                parse_query_range(value, predicate.time_min, predicate.time_max, true);
+            }else if(name == "value"){
+                parse_query_range(value, predicate.value_min, predicate.value_max, false);
+            }else{
+                printf("ERROR unknown query field %s\n", name.c_str());
+            }
+        }
+        group.predicates.push_back(predicate);
+    }
+    return group;
+}
+
+/**
+ * Splits a row in its columns.
+ * @param line
+ * @param row
+ * @return false for a line that is not a row
+ */
+
+bool split_query_row(std::string_view line, query_row &row){
+    line = trim_right(line);
+    if(line.empty() || line[0] < '0' || line[0] > '9'){
+        return false;
+    }
+    size_t time_end = line.find_first_of(" \t");
+    if(time_end == std::string_view::npos){
+        return false;
+    }
+    row.time = line.substr(0, time_end);
+
+    size_t component_begin = line.find_last_of(" \t");
+    row.component = line.substr(component_begin + 1);
+    size_t port_end = line.find_last_not_of(" \t", component_begin);
+    if(port_end == std::string_view::npos || port_end <= time_end){
+        return false;
+    }
+    size_t port_begin = line.find_last_of(" \t", port_end);
+    row.port = line.substr(port_begin + 1, port_end - port_begin);
+
+    size_t value_begin = line.find_first_not_of(" \t", time_end);
+    size_t value_end = line.find_last_not_of(" \t", port_begin);
+    if(value_begin == std::string_view::npos || value_end < value_begin){
+        row.value = std::string_view();
+    }else{
+        row.value = line.substr(value_begin, value_end - value_begin + 1);
+    }
+    return true;
+}
+
+/**
+ * Reads the first line of the file to tell a raw log from a table.
+ * @param fp
+ * @return true for a raw log
+ */
+
+bool is_raw_log(FILE *fp){
+    char *data = NULL;
+    size_t capacity = 0;
+    ssize_t length = getline(&data, &capacity, fp);
+    bool raw_log = length > 0 && (data[0] == '[' ||
+        is_time_line(trim_right(std::string_view(data, length))));
+    free(data);
+    rewind(fp);
+    return raw_log;
+}
+
+/**
+ * Writes the matching rows of every group in its own file.
+ * @param input
+ * @param groups
+ * @return number of rows read
+ */
+
+long run_queries(const char *input, std::vector<query_group> &groups){
+
+    FILE *fp = fopen(input,"r");
+    if(fp == NULL){
+        printf("ERROR in opening file");
+        return 0;
+    }
+    std::vector<FILE*> outputs;
+    for(query_group &group : groups){
+        group.matches = 0;
+        FILE *op = fopen(group.output.c_str(),"w");
+        if(op == NULL){
+            printf("ERROR in opening file");
+        }else{
+            write_output_header(op);
+        }
+        outputs.push_back(op);
+    }
+
+    /**<(group, predicate) pairs that accept a component/port pair*/
+    std::unordered_map<std::string, std::vector<std::pair<size_t, size_t>>> candidates;
+    std::string key;
+    std::vector<long> last_row(groups.size(), -1);
+    long rows = 0;
+
+    // write(op) writes the row to the file of a group it matches
+    auto query_row_of = [&](const query_row &row, auto write){
+        rows++;
+
+        key.assign(row.component);
+        key.push_back('\n');
+        key.append(row.port);
+        auto found = candidates.find(key);
+        if(found == candidates.end()){
+            std::vector<std::pair<size_t, size_t>> accepted;
+            for(size_t g = 0; g < groups.size(); g++){
+                for(size_t p = 0; p < groups[g].predicates.size(); p++){
+                    const query_predicate &predicate = groups[g].predicates[p];
+                    if((predicate.component.empty() || predicate.component == row.component) &&
+                        (predicate.port.empty() || predicate.port == row.port)){
+                        accepted.emplace_back(g, p);
+                    }
+                }
+            }
+            found = candidates.emplace(key, std::move(accepted)).first;
+        }
+        if(found->second.empty()){
+            return;
+        }
+
+        double time = log_time_to_seconds(row.time);
+        std::string value_text(row.value);
+        char *value_end;
+        double value = strtod(value_text.c_str(), &value_end);
+        bool numeric = value_end != value_text.c_str();
+
+        for(const auto &candidate : found->second){
+            const query_predicate &predicate =
+                groups[candidate.first].predicates[candidate.second];
+            if(last_row[candidate.first] == rows || time < predicate.time_min ||
+                time > predicate.time_max){
+                continue;
+            }
+            bool value_bounded = predicate.value_min !=
+                -std::numeric_limits<double>::infinity() ||
+                predicate.value_max != std::numeric_limits<double>::infinity();
+            if(value_bounded && (!numeric || value < predicate.value_min ||
+                value > predicate.value_max)){
+                continue;
+            }
+            last_row[candidate.first] = rows;
+            groups[candidate.first].matches++;
+            if(outputs[candidate.first] != NULL){
+                write(outputs[candidate.first]);
+            }
+        }
+    };
+
+    const bool raw_log = is_raw_log(fp);
+    /**<time of the bags of a raw log and the columns of their rows*/
+    std::string log_time;
+    std::string component;
+    std::string port;
+    std::string port_value;
+
+    // line is a row of the table, or a line of the raw log, with its end
+    // of line
+    auto query_line = [&](std::string_view line){
+        if(!raw_log){
+            query_row row;
+            if(split_query_row(line, row)){
+                query_row_of(row, [&](FILE *op){
+                    fwrite(line.data(), 1, line.size(), op);
+                });
+            }
+            return;
+        }
+        if(is_time_line(trim_right(line))){
+            log_time.assign(trim_right(line));
+            return;
+        }
+        std::string_view model;
+        for_each_port_value(line, model,
+            [&](std::string_view port_name, std::string_view value){
+                query_row row = {log_time, value, port_name, model};
+                query_row_of(row, [&](FILE *op){
+                    // output_filter keeps the space before the component name
+                    component.assign(" ");
+                    component.append(model);
+                    port.assign(port_name);
+                    port_value.assign(value);
+                    write_output_row(op, log_time.c_str(), port_value.c_str(),
+                        port.c_str(), component.c_str());
+                });
+            });
+    };
+
+    table_index index;
+    if(load_table_index(input, index)){
+        // only the blocks that can hold matching rows are read
+        std::vector<char> block_data;
+        for(uint32_t block : select_index_blocks(index, groups)){
+            const index_block &information = index.blocks[block];
+            block_data.resize(information.length);
+            if(fseek(fp, static_cast<long>(information.offset), SEEK_SET) != 0 ||
+                fread(block_data.data(), 1, information.length, fp) != information.length){
+                printf("ERROR in reading file");
+                break;
+            }
+            const char *position = block_data.data();
+            const char *end = position + block_data.size();
+            while(position < end){
+                const char *line_end = static_cast<const char*>(
+                    memchr(position, '\n', end - position));
+                line_end = line_end == NULL ? end : line_end + 1;
+                query_line(std::string_view(position, line_end - position));
+                position = line_end;
+            }
+        }
+    }else{
+        char *data = NULL;
+        size_t capacity = 0;
+        ssize_t length;
+        while((length = getline(&data, &capacity, fp)) != -1){
+            query_line(std::string_view(data, length));
+        }
+        free(data);
+    }
+    fclose(fp);
+
+    for(size_t g = 0; g < groups.size(); g++){
+        if(outputs[g] == NULL){
+            continue;
+        }
+        if(groups[g].matches == 0){
+            fprintf(outputs[g],"THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE");
+        }
+        fclose(outputs[g]);
+    }
+    return rows;
+}
@@ -0,0 +1,48 @@
+/**
+ * \brief This program selects rows of the output table with query groups.
+ *
+ * Every group is given as its text form (see query.hpp) followed by the
+ * file that receives its rows. All the groups are answered in a single
+ * pass over the table. A raw log of the simulator can be given instead of
+ * the table, its matching rows are written as the table rows.
+ *
+ * Usage: ./query_output path_to_output_table GROUP FILE [GROUP FILE ...]
+ *
+ * Example:
+ *   ./query_output ../data/output.txt
+ *       "component=sender1;port=ack_received_out" ../data/acks.txt
+ *       "component=subnet1|component=subnet2;time=..00:10:00:000" ../data/subnets.txt
+ */
+
+#include <iostream>
+#include <vector>
+
+#include "../text_filter.cpp"
+#include "../query.cpp"
+#include "../trace_index.cpp"
+
+using namespace std;
+
+int main(int argc, char ** argv){
+
+    if (argc < 4 || argc % 2 != 0) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the output table, then pairs of query"
+             << " group and output file" << endl;
+        return 1;
+    }
+
+    vector<query_group> groups;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        groups.push_back(parse_query_group(argv[i], argv[i + 1]));
+    }
+
+    long rows = run_queries(argv[1], groups);
+
+    cout << "Rows read: " << rows << endl;
+    for (const query_group &group : groups) {
+        cout << group.output << ": " << group.matches << " rows" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * \brief Monte Carlo replication runner for the ABP top model.
+ *
+ * This program runs many independent copies of the TOP model built by
+ * make_abp_top on a pool of threads. Every copy uses its own seed and logs
+ * in memory, then the throughput, the retransmissions and the completion
+ * time of all copies are reported with 95% confidence intervals.
+ *
+ * Usage: ./replicate_pg input_file replications [links] [threads] [seed]
+ *        [--delay=MODEL] [--loss=MODEL] [--protocol=PROTOCOL] [--rto=adaptive]
+ *
+ * The delay and loss models are described in channel_model.hpp, the
+ * protocols (abp, gbn:WINDOW, sr:WINDOW) in abp_topology.hpp. Running the
+ * same seeds with two protocols compares their throughput on the same
+ * channel, and the same holds for the fixed and the adaptive timeout.
+ *
+ * Every worker thread builds the TOP model once; its next replications
+ * reset the models with their seed (reset_abp_top) and the runner instead
+ * of building them again.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+#include <cadmium/modeling/coupling.hpp>
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/dynamic_model_translator.hpp>
+#include <cadmium/concept/coupled_model_assert.hpp>
+#include <cadmium/modeling/dynamic_coupled.hpp>
+#include <cadmium/modeling/dynamic_atomic.hpp>
+#include <cadmium/engine/pdevs_dynamic_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "../../include/message.hpp"
+
+
+#include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/abp_topology.hpp"
+#include "../../include/replication.hpp"
+#include "../../include/reusable_runner.hpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+/*************** Loggers *******************/
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages,
+                   cadmium::dynamic::logger::formatter<TIME>,
+                   replication_sink_provider>;
+using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time,
+                  cadmium::dynamic::logger::formatter<TIME>,
+                  replication_sink_provider>;
+using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+
+
+int main(int argc, char ** argv){
+
+    /**<positional arguments*/
+    vector<string> arguments;
+    /**<delay and loss models of the subnets*/
+    channel_config channel;
+    /**<protocol of the senders and receivers*/
+    protocol_config protocol;
+    /**<timeout of the abp senders computed from the round trip times*/
+    bool adaptive_timeout = false;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        try {
+            if (argument.rfind("--delay=", 0) == 0) {
+                channel.delay = argument.substr(8);
+            } else if (argument.rfind("--loss=", 0) == 0) {
+                channel.loss = argument.substr(7);
+            } else if (argument.rfind("--protocol=", 0) == 0) {
+                protocol = parse_protocol(argument.substr(11));
+            } else if (argument == "--rto=adaptive") {
+                adaptive_timeout = true;
+            } else {
+                arguments.push_back(argument);
+            }
+        } catch (const std::exception &e) {
+            cout << "wrong argument " << argument << ": " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (arguments.size() < 2) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the input file, number of replications "
+             << "[number of links] [number of threads] [first seed]"
+             << " [--delay=MODEL] [--loss=MODEL] [--protocol=PROTOCOL]"
+             << " [--rto=adaptive]" << endl;
+        return 1;
+    }
+
+    protocol.adaptive_timeout = adaptive_timeout;
+    const string input_data_control = arguments[0];
+    const int replications = atoi(arguments[1].c_str());
+    const int links = arguments.size() > 2 ? atoi(arguments[2].c_str()) : 1;
+    const unsigned int threads = arguments.size() > 3 ?
+        atoi(arguments[3].c_str()) : 0;
+    const unsigned int first_seed = arguments.size() > 4 ?
+        atoi(arguments[4].c_str()) : 1;
+
+    if (replications < 1 || links < 1) {
+        cout << "the number of replications and links should be at least 1"
+             << endl;
+        return 1;
+    }
+
+    try {
+        // the channel models are built once here, so a wrong model is
+        // reported before the simulation starts
+        channel_model check(channel);
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    auto start = hclock::now(); //to measure simulation execution time
+
+    vector<replication_result> results = run_replications(replications, threads,
+        [&](int replication){
+            const unsigned int seed = first_seed + replication;
+            // the payload pool of the thread is created before the runner of
+            // the thread, so it is destroyed after its models
+            payload_pool::local();
+            thread_local std::shared_ptr<checkpoint_registry<TIME>> models;
+            thread_local std::unique_ptr<reusable_runner<TIME, logger_top>> r;
+
+            replication_log().str("");
+            if (!r) {
+                models = std::make_shared<checkpoint_registry<TIME>>();
+                r = std::make_unique<reusable_runner<TIME, logger_top>>(
+                    make_abp_top<TIME>(input_data_control.c_str(), links, seed,
+                    channel, 0, protocol, models), TIME({0}));
+            } else {
+                reset_abp_top<TIME>(*models, seed);
+                r->reset({0});
+            }
+            r->run_until(NDTime("04:00:00:000"));
+
+            std::istringstream log(replication_log().str());
+            replication_log().str("");
+            replication_result result = summarize_replication(log);
+            result.seed = seed;
+            return result;
+        });
+
+    auto simulation_time = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+
+    print_replication_summary(cout, results);
+    cout << "Simulation took:" << simulation_time << "sec" << endl;
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * \brief ABP simulator built with static (compile time) coupled models.
+ *
+ * This program runs the top model of abp_static.hpp, the same hierarchy as
+ * main_pg with one link, on the static runner of cadmium. The log has the
+ * same format as the one of main_pg and is written to
+ * ../data/abp_output_static.txt. bench_pg compares both builds.
+ *
+ * Usage: ./static_pg input_file [--delay=MODEL] [--loss=MODEL] [--seed=N]
+ */
+
+#define STATIC_MODEL_OUTPUT "../data/abp_output_static.txt"
+
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include <cadmium/modeling/ports.hpp>
+#include <cadmium/modeling/coupled_model.hpp>
+#include <cadmium/engine/pdevs_runner.hpp>
+#include <cadmium/logger/tuple_to_ostream.hpp>
+#include <cadmium/logger/common_loggers.hpp>
+#include "../../include/message.hpp"
+
+
+#include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/abp_static.hpp"
+
+using namespace std;
+using hclock=chrono::high_resolution_clock;
+using TIME = NDTime;
+
+/*************** Loggers *******************/
+static ofstream out_data(STATIC_MODEL_OUTPUT);
+struct oss_sink_provider{
+    static ostream& sink(){
+        return out_data;
+    }
+};
+
+using log_messages=cadmium::logger::logger<cadmium::logger::logger_messages,
+                   cadmium::logger::verbatim_formatter, oss_sink_provider>;
+using global_time=cadmium::logger::logger<cadmium::logger::logger_global_time,
+                  cadmium::logger::verbatim_formatter, oss_sink_provider>;
+using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+
+
+int main(int argc, char ** argv){
+
+    abp_static_settings &settings = abp_static_config();
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        try {
+            if (argument.rfind("--delay=", 0) == 0) {
+                settings.channel.delay = argument.substr(8);
+            } else if (argument.rfind("--loss=", 0) == 0) {
+                settings.channel.loss = argument.substr(7);
+            } else if (argument.rfind("--seed=", 0) == 0) {
+                settings.seed = stoul(argument.substr(7));
+            } else if (settings.input.empty()) {
+                settings.input = argument;
+            }
+        } catch (const std::exception &e) {
+            cout << "wrong argument " << argument << ": " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (settings.input.empty()) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the input file"
+             << " [--delay=MODEL] [--loss=MODEL] [--seed=N]" << endl;
+        return 1;
+    }
+
+    try {
+        // the channel models are built once here, so a wrong model is
+        // reported before the simulation starts
+        channel_model check(settings.channel);
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    auto start = hclock::now(); //to measure simulation execution time
+
+    cadmium::engine::runner<TIME, abp_static_top, logger_top> r{TIME({0})};
+    auto time_elapsed = std::chrono::duration_cast<std::chrono::duration<double,
+                    std::ratio<1>>>(hclock::now() - start).count();
+    cout << "Runner Created. Elapsed time: " << time_elapsed << "sec" << endl;
+    cout << "Simulation starts" << endl;
+    r.runUntil(NDTime("04:00:00:000"));
+    auto simulation_time = std::chrono::duration_cast<std::chrono::duration<double,
+                   std::ratio<1>>>(hclock::now() - start).count();
+    cout << "Simulation took:" << simulation_time << "sec" << endl;
+
+    out_data.flush();
+    return 0;
+}
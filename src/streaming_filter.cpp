@@ -0,0 +1,127 @@
+/**
+ * \brief This code writes output.txt and limit_output.txt in a single pass,
+ * while the simulation writes its log.
+ *
+ * The rows are the same as the ones of output_filter, and a row is copied
+ * to the limit table when its port and component are the ones of one of the
+ * compare structures, as limit_output does on output.txt. When no row
+ * matches, the limit table ends with the same message as limit_output.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/streaming_filter.hpp"
+#include "../include/log_parser.hpp"
+#include "../include/filter.hpp"
+
+/**
+ * Closes the files if close was not called.
+ */
+
+streaming_filter_streambuf::~streaming_filter_streambuf(){
+    close();
+}
+
+/**
+ * Opens the output table, the limit table and, if asked, the raw log.
+ * @param output
+ * @param limit
+ * @param limits
+ * @param raw
+ * @return false if a file cannot be opened
+ */
+
+bool streaming_filter_streambuf::open(const char *output, const char *limit,
+    const std::vector<compare> &limits, const char *raw){
+
+    close();
+    op = fopen(output,"w");
+    lp = fopen(limit,"w");
+    if(raw != NULL){
+        rp = fopen(raw,"w");
+    }
+    if(op == NULL || lp == NULL || (raw != NULL && rp == NULL)){
+        printf("ERROR in opening file");
+        for(FILE **file : {&op, &lp, &rp}){
+            if(*file != NULL){
+                fclose(*file);
+                *file = NULL;
+            }
+        }
+        return false;
+    }
+    this->limits = limits;
+    limit_rows = 0;
+    time.clear();
+
+    write_output_header(op);
+    write_output_header(lp);
+    return true;
+}
+
+/**
+ * Writes the last line and closes the files.
+ */
+
+void streaming_filter_streambuf::close(){
+    if(op == NULL && lp == NULL && rp == NULL){
+        return;
+    }
+    flush_lines();
+    if(lp != NULL && limit_rows == 0){
+        printf("THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE");
+        fprintf(lp,"THERE IS NO MATCHING OUTPUT TO SHOW IN THE NEW FILE");
+    }
+    for(FILE **file : {&op, &lp, &rp}){
+        if(*file != NULL){
+            fclose(*file);
+            *file = NULL;
+        }
+    }
+}
+
+/**
+ * Turns one logger line into rows of the output table and copies the rows
+ * that match a compare structure to the limit table.
+ * @param line
+ */
+
+void streaming_filter_streambuf::on_line(std::string_view line){
+    if(op == NULL){
+        return;
+    }
+    if(rp != NULL){
+        fwrite(line.data(), 1, line.size(), rp);
+        fputc('\n', rp);
+    }
+    if(is_time_line(line)){
+        time.assign(trim_right(line));
+        return;
+    }
+    std::string_view model;
+    for_each_port_value(line, model,
+        [&](std::string_view port_name, std::string_view value){
+            // output_filter keeps the space before the component name
+            component.assign(" ");
+            component.append(model);
+            port.assign(port_name);
+            port_value.assign(value);
+
+            int length = format_output_row(NULL, 0, time.c_str(),
+                port_value.c_str(), port.c_str(), component.c_str());
+            row.resize(length + 1);
+            format_output_row(row.data(), row.size(), time.c_str(),
+                port_value.c_str(), port.c_str(), component.c_str());
+            fwrite(row.data(), 1, length, op);
+
+            for(const compare &c : limits){
+                if(port == c.port1 && model == c.component1){
+                    fwrite(row.data(), 1, length, lp);
+                    limit_rows++;
+                    break;
+                }
+            }
+        });
+}
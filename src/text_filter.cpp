@@ -41,6 +41,52 @@ char* trim(char* p_input){
     return p_input;
 }
 
+/**
+ * This function writes the headings of the output table.
+ * @param op
+ */
+
+void write_output_header(FILE *op){
+    char first_line[500] = "TIME\t\tVALUE\t\t\tPORT\t\tCOMPONENT\n";
+    fputs(first_line, op);
+}
+
+/**<format of one row of the output table*/
+static const char OUTPUT_ROW_FORMAT[] = "%-18s %-16s %-18s %-18s \n";
+
+/**
+ * This function writes one row of the output table. The component is
+ * written as given, output_filter passes it with its leading space.
+ * @param op
+ * @param time
+ * @param port_value
+ * @param port
+ * @param component
+ */
+
+void write_output_row(FILE *op, const char *time, const char *port_value,
+    const char *port, const char *component){
+    fprintf(op,OUTPUT_ROW_FORMAT,time,port_value,port,component);
+}
+
+/**
+ * This function formats one row of the output table in a buffer, as
+ * write_output_row writes it, for the filters that write a row to more
+ * than one file.
+ * @param row buffer, can be NULL when size is 0
+ * @param size bytes of the buffer
+ * @param time
+ * @param port_value
+ * @param port
+ * @param component
+ * @return the length of the row, as snprintf
+ */
+
+int format_output_row(char *row, size_t size, const char *time,
+    const char *port_value, const char *port, const char *component){
+    return snprintf(row,size,OUTPUT_ROW_FORMAT,time,port_value,port,component);
+}
+
 /**
  * This function is for arranging the unrecognizable output
  * in to a correct readable format.This fuction will take unreadable output file
@@ -92,11 +138,10 @@ void output_filter(const char *input,const char *output){
         printf("ERROR in opening file");
     }
 
-    char first_line[500] = "TIME\t\tVALUE\t\t\tPORT\t\tCOMPONENT\n";
     /**
      * writing the output headings to the output file
      */
-    fputs(first_line, op);
+    write_output_header(op);
     if(fp == NULL){
         printf("ERROR in opening file");
     }
@@ -175,7 +220,7 @@ void output_filter(const char *input,const char *output){
                     /**
                      * writes the output to the new file
                      */
-                    fprintf(op,"%-18s %-16s %-18s %-18s \n",time,port_value,port,component);
+                    write_output_row(op,time,port_value,port,component);
 
                 }
 
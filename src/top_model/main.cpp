@@ -2,6 +2,9 @@
 #define TOP_MODEL_OUTPUT "../data/abp_output_0.txt"
 #define FILTER_OUTPUT  "../data/output.txt"
 #define LIMIT_OUTPUT  "../data/limit_output.txt"
+#define TOP_MODEL_TRACE "../data/abp_output_0.bin"
+#define INSTRUMENTATION_OUTPUT "../data/instrumentation.json"
+#define CHECKPOINT_OUTPUT "../data/abp_checkpoint.txt"
 
 
 #include <iostream>
@@ -9,6 +12,8 @@
 #include <algorithm>
 #include <string>
 
+#include <unistd.h>
+
 #include <cadmium/modeling/coupling.hpp>
 #include <cadmium/modeling/ports.hpp>
 #include <cadmium/modeling/dynamic_model_translator.hpp>
@@ -22,44 +27,50 @@
 
 
 #include "../../lib/DESTimes/include/NDTime.hpp"
+#include "../../include/tick_time.hpp"
 #include "../../lib/vendor/include/iestream.hpp"
 #include "../../include/receiver_cadmium.hpp"
 #include "../../include/sender_cadmium.hpp"
 #include "../../include/subnet_cadmium.hpp"
+#include "../../include/abp_topology.hpp"
+#include "../../include/checkpoint.hpp"
+#include "../../include/steady_state.hpp"
+#include "../../include/log_filter.hpp"
 
 #include "../../src/text_filter.cpp"
+#include "../../src/fast_filter.cpp"
+#include "../../src/query.cpp"
+#include "../../src/trace_index.cpp"
 #include "../../src/limit_output.cpp"
+#include "../../src/trace_binary.cpp"
+#include "../../src/streaming_filter.cpp"
+#include "../../src/async_log.cpp"
 
 #include "../../include/limit.hpp"
 #include "../../include/filter.hpp"
+#include "../../include/trace_binary.hpp"
+#include "../../include/streaming_filter.hpp"
+#include "../../include/async_log.hpp"
 
 using namespace std;
 using hclock=chrono::high_resolution_clock;
+// main_tick_pg is this program built with ABP_TICK_TIME: the models run on
+// the integer tick_time instead of NDTime and write the same log
+#ifdef ABP_TICK_TIME
+using TIME = tick_time;
+#else
 using TIME = NDTime;
+#endif
 
-
-/***** SETING INPUT PORTS FOR COUPLEDs *****/
-struct input_control : public cadmium::in_port<message_t>{};
-struct input_1 : public cadmium::in_port<message_t>{};
-struct input_2 : public cadmium::in_port<message_t>{};
-
-/***** SETING OUTPUT PORTS FOR COUPLEDs *****/
-struct output_acknowledge : public cadmium::out_port<message_t>{};
-struct output_1 : public cadmium::out_port<message_t>{};
-struct output_2 : public cadmium::out_port<message_t>{};
-struct output_pack : public cadmium::out_port<message_t>{};
-
-
-/********************************************/
-/****** APPLICATION GENERATOR *******************/
-/********************************************/
-template<typename T>
-class ApplicationGen : public iestream_input<message_t,T> {
-    public:
-    ApplicationGen() = default;
-    ApplicationGen(const char* file_path) : iestream_input<message_t,
-        T>(file_path) {}
-};
+// main_filtered_pg is this program built with ABP_LOG_FILTER: only the
+// messages of these models and ports are logged, the rest of the log is
+// never formatted. Change them to analyze something else.
+#ifdef ABP_LOG_FILTER
+static constexpr char LOGGED_SENDERS[] = "sender";
+using logged_models = keep_models<LOGGED_SENDERS>;
+using logged_ports = keep_ports<sender_defs::packet_sent_out,
+                                sender_defs::ack_received_out>;
+#endif
 
 
 int main(int argc, char ** argv){
@@ -68,20 +79,195 @@ int main(int argc, char ** argv){
     const char *p_output_file = FILTER_OUTPUT;
     const char *p_limit_file = LIMIT_OUTPUT;
 
-    if (argc < 2) {
+    /**<positional arguments: input file and number of links*/
+    vector<string> arguments;
+    /**<number of independent Sender/Receiver/Network links under TOP*/
+    int links = 1;
+    /**<seed of the subnets*/
+    unsigned int seed = 0;
+    /**<delay and loss models of the subnets*/
+    channel_config channel;
+    /**<write the log as a binary trace instead of text*/
+    bool binary_trace = false;
+    /**<write output.txt and limit_output.txt while the simulation runs*/
+    bool stream_tables = false;
+    /**<keep the raw log when the tables are streamed*/
+    bool raw_log = false;
+    /**<payload bytes of every data packet*/
+    uint32_t payload_length = 0;
+    /**<protocol of the senders and receivers*/
+    protocol_config protocol;
+    /**<timeout of the abp senders computed from the round trip times*/
+    bool adaptive_timeout = false;
+    /**<checkpoint file written and read back by --restart*/
+    string checkpoint_path = CHECKPOINT_OUTPUT;
+    /**<simulated time between two checkpoints, 0 for none*/
+    TIME checkpoint_every = TIME();
+    /**<resume from the checkpoint instead of starting at 0*/
+    bool restart = false;
+    /**<time the simulation stops at*/
+    TIME end_time = TIME("04:00:00:000");
+    /**<relative half width that stops the run in steady state, 0 for none*/
+    double steady_state_target = 0;
+    /**<length of one throughput observation of the steady state mode*/
+    TIME observation = TIME("00:05:00:000");
+    /**<write the text log on a background thread*/
+    bool async_log = false;
+    /**<ring size and full ring policy of the background log*/
+    async_log_config async_config;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+        try {
+            if (argument.rfind("--delay=", 0) == 0) {
+                channel.delay = argument.substr(8);
+            } else if (argument.rfind("--loss=", 0) == 0) {
+                channel.loss = argument.substr(7);
+            } else if (argument.rfind("--seed=", 0) == 0) {
+                seed = stoul(argument.substr(7));
+            } else if (argument == "--trace=binary") {
+                binary_trace = true;
+                stream_tables = false;
+            } else if (argument == "--trace=stream") {
+                stream_tables = true;
+                binary_trace = false;
+            } else if (argument == "--trace=text") {
+                binary_trace = false;
+                stream_tables = false;
+            } else if (argument.rfind("--payload=", 0) == 0) {
+                payload_length = stoul(argument.substr(10));
+            } else if (argument.rfind("--protocol=", 0) == 0) {
+                protocol = parse_protocol(argument.substr(11));
+            } else if (argument == "--rto=adaptive") {
+                adaptive_timeout = true;
+            } else if (argument == "--rto=fixed") {
+                adaptive_timeout = false;
+            } else if (argument == "--raw-log") {
+                raw_log = true;
+            } else if (argument.rfind("--checkpoint=", 0) == 0) {
+                checkpoint_path = argument.substr(13);
+            } else if (argument.rfind("--checkpoint-every=", 0) == 0) {
+                checkpoint_every = TIME(argument.substr(19));
+            } else if (argument == "--restart") {
+                restart = true;
+            } else if (argument.rfind("--horizon=", 0) == 0) {
+                end_time = TIME(argument.substr(10));
+            } else if (argument.rfind("--steady-state=", 0) == 0) {
+                steady_state_target = stod(argument.substr(15));
+            } else if (argument.rfind("--observation=", 0) == 0) {
+                observation = TIME(argument.substr(14));
+            } else if (argument == "--async-log") {
+                async_log = true;
+            } else if (argument.rfind("--async-log=", 0) == 0) {
+                async_log = true;
+                parse_async_log_policy(argument.substr(12), async_config);
+            } else if (argument.rfind("--async-buffer=", 0) == 0) {
+                async_config.capacity = stoul(argument.substr(15));
+            } else {
+                arguments.push_back(argument);
+            }
+        } catch (const std::exception &e) {
+            cout << "wrong argument " << argument << ": " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (arguments.empty()) {
         cout << "you are using this program with wrong parameters.";
         cout << "The program should be invoked as follow:";
-        cout << argv[0] << " path to the input file " << endl;
+        cout << argv[0] << " path to the input file [number of links]"
+             << " [--delay=MODEL] [--loss=MODEL] [--seed=N]"
+             << " [--trace=text|binary|stream] [--raw-log]"
+             << " [--payload=BYTES] [--protocol=abp|gbn:WINDOW|sr:WINDOW]"
+             << " [--rto=fixed|adaptive] [--checkpoint=PATH]"
+             << " [--checkpoint-every=HH:MM:SS] [--restart]"
+             << " [--horizon=HH:MM:SS] [--steady-state=HALF_WIDTH]"
+             << " [--observation=HH:MM:SS]"
+             << " [--async-log[=block|block:SECONDS|drop]] [--async-buffer=BYTES]"
+             << endl;
+        return 1;
+    }
+    if (steady_state_target > 0 &&
+        (restart || checkpoint_every > TIME() || !(observation > TIME()))) {
+        // the observations of the monitor are not in the checkpoints
+        cout << "--steady-state needs an observation length and no checkpoints"
+             << endl;
+        return 1;
+    }
+    if ((restart || checkpoint_every > TIME()) &&
+        (binary_trace || stream_tables || protocol.name != "abp")) {
+        // the log is cut back to the checkpoint, and only the abp models
+        // write their state
+        cout << "checkpoints need --trace=text and --protocol=abp" << endl;
         return 1;
     }
+    if (async_log && (binary_trace || stream_tables || restart ||
+        checkpoint_every > TIME())) {
+        // the checkpoints take the size of the log written so far
+        cout << "--async-log needs --trace=text and no checkpoints" << endl;
+        return 1;
+    }
+
+    try {
+        // the channel models are built once here, so a wrong model is
+        // reported before the simulation starts
+        channel_model check(channel);
+    } catch (const std::exception &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    if (arguments.size() > 1) {
+        links = atoi(arguments[1].c_str());
+        if (links < 1) {
+            cout << "the number of links should be at least 1" << endl;
+            return 1;
+        }
+    }
+
+    /**<rows of output.txt copied to limit_output.txt*/
+    struct compare c1;
+    strcpy(c1.port1,"ack_received_out");
+    strcpy(c1.component1,"sender1");
 
     auto start = hclock::now(); //to measure simulation execution time
 
 /*************** Loggers *******************/
-    static std::ofstream out_data(TOP_MODEL_OUTPUT);
+    static std::ofstream out_data;
+    static async_log_streambuf out_async;
+    static trace_binary_streambuf out_trace;
+    static streaming_filter_streambuf out_tables;
+    static std::ostream out_log(nullptr);
+    if (binary_trace) {
+        if (!out_trace.open(TOP_MODEL_TRACE)) {
+            return 1;
+        }
+        out_log.rdbuf(&out_trace);
+    } else if (stream_tables) {
+        if (!out_tables.open(p_output_file, p_limit_file, {c1},
+            raw_log ? TOP_MODEL_OUTPUT : NULL)) {
+            return 1;
+        }
+        out_log.rdbuf(&out_tables);
+    } else if (async_log) {
+        if (!out_async.open(TOP_MODEL_OUTPUT, async_config)) {
+            return 1;
+        }
+        out_log.rdbuf(&out_async);
+    } else if (!restart) {
+        out_data.open(TOP_MODEL_OUTPUT);
+        out_log.rdbuf(out_data.rdbuf());
+    }
+    // the steady state monitor sees the log lines before the log does
+    static std::unique_ptr<steady_state_monitor> monitor;
+    if (steady_state_target > 0) {
+        monitor = std::make_unique<steady_state_monitor>(
+            time_to_seconds(observation), out_log.rdbuf());
+        out_log.rdbuf(monitor.get());
+    }
     struct oss_sink_provider{
         static std::ostream& sink(){          
-        return out_data;
+        return out_log;
         }
     };
 
@@ -108,7 +294,13 @@ int main(int argc, char ** argv){
                      oss_sink_provider>;
     using log_all=cadmium::logger::multilogger<info, debug, state,
                   log_messages,routing, global_time, local_time>;
+#ifdef ABP_LOG_FILTER
+    using logger_top=filtered_logger<logged_models, logged_ports,
+                     cadmium::dynamic::logger::formatter<TIME>,
+                     oss_sink_provider>;
+#else
     using logger_top=cadmium::logger::multilogger<log_messages, global_time>;
+#endif
 
 
 /*******************************************/
@@ -116,177 +308,159 @@ int main(int argc, char ** argv){
 
 
 /********************************************/
-/****** APPLICATION GENERATOR *******************/
+/****** TOP MODEL *******************/
 /********************************************/
-    string input_data_control = argv[1];
+    protocol.adaptive_timeout = adaptive_timeout;
+    protocol.statistics = std::make_shared<sender_statistics>();
+    string input_data_control = arguments[0];
     const char * p_input_data_control = input_data_control.c_str();
 
-    std::shared_ptr<cadmium::dynamic::modeling::model> generator_con =
-    cadmium::dynamic::translate::make_dynamic_atomic_model<ApplicationGen,
-    TIME,const char* >("generator_con" , std::move(p_input_data_control));
-
-
-/********************************************/
-/****** SENDER *******************/
-/********************************************/
-
-    std::shared_ptr<cadmium::dynamic::modeling::model> sender1 =
-    cadmium::dynamic::translate::make_dynamic_atomic_model<Sender,
-    TIME>("sender1");
-
-/********************************************/
-/****** RECIEVER *******************/
-/********************************************/
-
-    std::shared_ptr<cadmium::dynamic::modeling::model> receiver1 =
-    cadmium::dynamic::translate::make_dynamic_atomic_model<Receiver,
-    TIME>("receiver1");
-
-
-
-/********************************************/
-/****** SUBNET *******************/
-/********************************************/
-
-    std::shared_ptr<cadmium::dynamic::modeling::model> subnet1 =
-    cadmium::dynamic::translate::make_dynamic_atomic_model<Subnet,
-    TIME>("subnet1");
-    std::shared_ptr<cadmium::dynamic::modeling::model> subnet2 =
-    cadmium::dynamic::translate::make_dynamic_atomic_model<Subnet,
-    TIME>("subnet2");
-
-/************************/
-/*******NETWORK********/
-/************************/
-    cadmium::dynamic::modeling::Ports iports_Network = {
-        typeid(input_1),typeid(input_2)
-    };
-    cadmium::dynamic::modeling::Ports oports_Network = {
-        typeid(output_1),typeid(output_2)
-    };
-    cadmium::dynamic::modeling::Models submodels_Network = {
-        subnet1, subnet2
-    };
-    cadmium::dynamic::modeling::EICs eics_Network = {
-        cadmium::dynamic::translate::make_EIC<input_1,
-        subnet_defs::input>("subnet1"),
-        cadmium::dynamic::translate::make_EIC<input_2,
-        subnet_defs::input>("subnet2")
-    };
-    cadmium::dynamic::modeling::EOCs eocs_Network = {
-        cadmium::dynamic::translate::make_EOC<subnet_defs::output,
-        output_1>("subnet1"),
-        cadmium::dynamic::translate::make_EOC<subnet_defs::output,
-        output_2>("subnet2")
-    };
-    cadmium::dynamic::modeling::ICs ics_Network = {};
-    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> NETWORK =
-    std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
-        "Network",
-        submodels_Network,
-        iports_Network,
-        oports_Network,
-        eics_Network,
-        eocs_Network,
-        ics_Network
-    );
-
-/************************/
-/*******ABPSimulator********/
-/************************/
-    cadmium::dynamic::modeling::Ports iports_ABPSimulator = {
-        typeid(input_control)
-    };
-    cadmium::dynamic::modeling::Ports oports_ABPSimulator ={
-        typeid(output_acknowledge),typeid(output_pack)
-    };
-    cadmium::dynamic::modeling::Models submodels_ABPSimulator = {
-        sender1,receiver1,NETWORK
-    };
-    cadmium::dynamic::modeling::EICs eics_ABPSimulator = {
-        cadmium::dynamic::translate::make_EIC<input_control,
-        sender_defs::control_in>("sender1")
-    };
-    cadmium::dynamic::modeling::EOCs eocs_ABPSimulator = {
-        cadmium::dynamic::translate::make_EOC<sender_defs::packet_sent_out,
-        output_pack>("sender1"),
-        cadmium::dynamic::translate::make_EOC<sender_defs::ack_received_out,
-        output_acknowledge>("sender1")
-    };
-    cadmium::dynamic::modeling::ICs ics_ABPSimulator = {
-        cadmium::dynamic::translate::make_IC<sender_defs::data_out,
-        input_1>("sender1","Network"),
-        cadmium::dynamic::translate::make_IC<output_2,
-        sender_defs::ack_in>("Network","sender1"),
-        cadmium::dynamic::translate::make_IC<receiver_defs::output,
-        input_2>("receiver1","Network"),
-        cadmium::dynamic::translate::make_IC<output_1,
-        receiver_defs::input>("Network","receiver1")
-    };
-    std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> ABPSimulator =
-    std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
-        "ABPSimulator",
-        submodels_ABPSimulator,
-        iports_ABPSimulator,
-        oports_ABPSimulator,
-        eics_ABPSimulator,
-        eocs_ABPSimulator,
-        ics_ABPSimulator
-    );
-
-
-/************************/
-/*******TOP MODEL********/
-/************************/
-    cadmium::dynamic::modeling::Ports iports_TOP = {};
-    cadmium::dynamic::modeling::Ports oports_TOP = {
-        typeid(output_pack),typeid(output_acknowledge)
-    };
-    cadmium::dynamic::modeling::Models submodels_TOP = {
-        generator_con, ABPSimulator
-    };
-    cadmium::dynamic::modeling::EICs eics_TOP = {};
-    cadmium::dynamic::modeling::EOCs eocs_TOP = {
-        cadmium::dynamic::translate::make_EOC<output_pack,
-        output_pack>("ABPSimulator"),
-        cadmium::dynamic::translate::make_EOC<output_pack,
-        output_acknowledge>("ABPSimulator")
-    };
-    cadmium::dynamic::modeling::ICs ics_TOP = {
-        cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
-        input_control>("generator_con","ABPSimulator")
-    };
+    /**<models written to the checkpoints, only with checkpoints*/
+    std::shared_ptr<checkpoint_registry<TIME>> checkpoints;
+    if (restart || checkpoint_every > TIME()) {
+        checkpoints = std::make_shared<checkpoint_registry<TIME>>();
+    }
     std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
-    std::make_shared<cadmium::dynamic::modeling::coupled<TIME>>(
-        "TOP",
-        submodels_TOP,
-        iports_TOP,
-        oports_TOP,
-        eics_TOP,
-        eocs_TOP,
-        ics_TOP
-    );
+    make_abp_top<TIME>(p_input_data_control, links, seed, channel,
+        payload_length, protocol, checkpoints);
 
 ///****************////
 
+    /**<statistics of the senders, saved with the models*/
+    std::shared_ptr<sender_statistics> statistics = protocol.statistics;
+    /**<time the runner starts at, the checkpoint time with --restart*/
+    TIME start_time = TIME();
+    if (restart) {
+        uint64_t log_offset = 0;
+        if (!read_checkpoint<TIME>(*checkpoints, checkpoint_path.c_str(),
+            start_time, log_offset, [statistics](checkpoint_reader &reader){
+                statistics->load_checkpoint(reader);
+            })) {
+            return 1;
+        }
+        // the log goes on from the line the checkpoint was taken at
+        if (truncate(TOP_MODEL_OUTPUT, log_offset) != 0) {
+            printf("ERROR in opening file");
+            return 1;
+        }
+        out_data.open(TOP_MODEL_OUTPUT, std::ios::in | std::ios::out | std::ios::ate);
+        cout << "Restarted from " << checkpoint_path << " at " << start_time
+             << endl;
+    }
+
     auto time_elapsed = std::chrono::duration_cast<std::chrono::duration<double,
                     std::ratio<1>>>(hclock::now() - start).count();
     cout << "Model Created. Elapsed time: " << time_elapsed << "sec" << endl;
-    cadmium::dynamic::engine::runner<NDTime, logger_top> r(TOP, {0});
+    // with --restart the log is only attached once the runner is built, the
+    // time it logs is already in the log
+    cadmium::dynamic::engine::runner<TIME, logger_top> r(TOP, start_time);
+    if (restart) {
+        out_log.rdbuf(out_data.rdbuf());
+    }
     time_elapsed = std::chrono::duration_cast<std::chrono::duration<double,
                std::ratio<1>>>(hclock::now() - start).count();
     cout << "Runner Created. Elapsed time: " << time_elapsed << "sec" << endl;
     cout << "Simulation starts" << endl;
-    r.run_until(NDTime("04:00:00:000"));
+    /**<time the steady state mode stopped the run at*/
+    TIME stopped_at = end_time;
+    steady_state_estimate throughput, latency;
+    if (checkpoint_every > TIME()) {
+        for (TIME next = start_time + checkpoint_every; next < end_time;
+            next = next + checkpoint_every) {
+            r.run_until(next);
+            out_log.flush();
+            if (!write_checkpoint<TIME>(*checkpoints, checkpoint_path.c_str(),
+                next, static_cast<uint64_t>(out_data.tellp()),
+                [statistics](checkpoint_writer &writer){
+                    statistics->save_checkpoint(writer);
+                })) {
+                return 1;
+            }
+        }
+    }
+    if (steady_state_target > 0) {
+        // one observation at a time until both intervals are narrow enough
+        for (TIME next = start_time + observation; next < end_time;
+            next = next + observation) {
+            r.run_until(next);
+            monitor->advance_to(time_to_seconds(next));
+            throughput = estimate_steady_state(monitor->throughput());
+            latency = estimate_steady_state(monitor->latency());
+            if (throughput.relative_half_width() <= steady_state_target &&
+                latency.relative_half_width() <= steady_state_target) {
+                stopped_at = next;
+                break;
+            }
+        }
+    }
+    if (stopped_at == end_time) {
+        r.run_until(end_time);
+        if (steady_state_target > 0) {
+            monitor->advance_to(time_to_seconds(end_time));
+            throughput = estimate_steady_state(monitor->throughput());
+            latency = estimate_steady_state(monitor->latency());
+        }
+    }
     auto simulation_time = std::chrono::duration_cast<std::chrono::duration<double,
                    std::ratio<1>>>(hclock::now() - start).count();
     cout << "Simulation took:" << simulation_time << "sec" << endl;
+#ifdef ABP_INSTRUMENTATION
+    if (write_instrumentation_report(INSTRUMENTATION_OUTPUT)) {
+        cout << "Instrumentation report: " << INSTRUMENTATION_OUTPUT << endl;
+    }
+#endif
+    cout << "Links simulated: " << links << endl;
+    if (steady_state_target > 0) {
+        if (stopped_at == end_time) {
+            cout << "Steady state target not reached before " << end_time << endl;
+        } else {
+            cout << "Steady state target reached at " << stopped_at << endl;
+        }
+        const std::pair<const char*, const steady_state_estimate*> rows[] = {
+            {"throughput (packets/s)", &throughput}, {"latency (s)", &latency}
+        };
+        for (const auto &row : rows) {
+            const steady_state_estimate &estimate = *row.second;
+            cout << row.first << ": " << estimate.interval.mean << " +/- "
+                 << estimate.interval.half_width << " (95% CI, "
+                 << STEADY_STATE_BATCHES << " batches of "
+                 << estimate.batch_size << ", warm-up " << estimate.truncated
+                 << " of " << estimate.observations << " observations)" << endl;
+        }
+    }
+    if (protocol.name == "abp") {
+        cout << (adaptive_timeout ? "Adaptive" : "Fixed") << " timeout" << endl;
+        protocol.statistics->print(cout);
+    }
+    if (payload_length > 0) {
+        const payload_pool::counters &pool = payload_pool::local().statistics();
+        cout << "Payload pool: " << pool.hits << " hits, " << pool.misses
+             << " misses, " << pool.peak_in_use << " payloads in use at most, "
+             << pool.bytes_reserved << " bytes reserved" << endl;
+    }
 
-    output_filter(p_input_file,p_output_file);
+    out_log.flush();
+    if (monitor) {
+        monitor->flush_lines();
+    }
+    if (stream_tables) {
+        // output.txt and limit_output.txt are already written
+        out_tables.close();
+        return 0;
+    }
+    if (binary_trace) {
+        out_trace.close();
+        trace_to_output(TOP_MODEL_TRACE,p_output_file);
+    } else {
+        if (async_log) {
+            out_async.close();
+            out_async.statistics().print(cout);
+        } else {
+            out_data.close();
+        }
+        output_filter_mmap(p_input_file,p_output_file);
+    }
 
-    struct compare c1;
-    strcpy(c1.port1,"ack_received_out");
-    strcpy(c1.component1,"sender1");
     limit_output(p_output_file,p_limit_file,1,c1);
 
     return 0;
@@ -0,0 +1,368 @@
+/**
+ * \brief This code writes and reads the binary trace of a simulation.
+ *
+ * trace_binary_streambuf is plugged in the logger sink of the top model and
+ * stores every message as a fixed size record, trace_reader reads those
+ * records back and trace_to_output writes the same table as output_filter
+ * from a binary trace, without any text parsing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <charconv>
+
+#include "../include/trace_binary.hpp"
+#include "../include/log_parser.hpp"
+#include "../include/filter.hpp"
+
+/**<number of records written or read at once*/
+static constexpr size_t TRACE_BUFFER_RECORDS = 1 << 14;
+
+/**
+ * Completes the trace if close was not called.
+ */
+
+trace_binary_streambuf::~trace_binary_streambuf(){
+    close();
+}
+
+/**
+ * Opens the trace file and reserves the space of the header, which is
+ * completed by close.
+ * @param path
+ * @return false if the file cannot be opened
+ */
+
+bool trace_binary_streambuf::open(const char *path){
+    close();
+    file = fopen(path, "wb");
+    if(file == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    trace_header header = {};
+    fwrite(&header, sizeof(header), 1, file);
+    records.reserve(TRACE_BUFFER_RECORDS);
+    record_count = 0;
+    time = 0;
+    return true;
+}
+
+/**
+ * Writes the pending records and the dictionary, then rewrites the header
+ * with the number of records and the position of the dictionary.
+ * Dictionary layout: number of models, the models, number of ports, the
+ * ports; every name is its length (uint16_t) followed by its characters.
+ */
+
+void trace_binary_streambuf::close(){
+    if(file == NULL){
+        return;
+    }
+    flush_lines();
+    write_records();
+
+    trace_header header = {};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.record_size = sizeof(trace_record);
+    header.record_count = record_count;
+    header.dictionary_offset = sizeof(trace_header) +
+        record_count * sizeof(trace_record);
+
+    for(const std::vector<std::string> *names : {&model_names, &port_names}){
+        uint32_t count = static_cast<uint32_t>(names->size());
+        fwrite(&count, sizeof(count), 1, file);
+        for(const std::string &name : *names){
+            uint16_t length = static_cast<uint16_t>(name.size());
+            fwrite(&length, sizeof(length), 1, file);
+            fwrite(name.data(), 1, length, file);
+        }
+    }
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    fclose(file);
+    file = NULL;
+}
+
+/**
+ * Gives the index of a name, adding it to the dictionary the first time.
+ * @param ids index of every known name
+ * @param names known names in index order
+ * @param name name to look for
+ * @return the index of the name
+ */
+
+uint16_t trace_binary_streambuf::intern(
+    std::unordered_map<std::string, uint16_t> &ids,
+    std::vector<std::string> &names, std::string_view name){
+
+    std::string key(name);
+    auto found = ids.find(key);
+    if(found != ids.end()){
+        return found->second;
+    }
+    uint16_t id = static_cast<uint16_t>(names.size());
+    ids.emplace(key, id);
+    names.push_back(std::move(key));
+    return id;
+}
+
+/**
+ * Writes the buffered records to the file.
+ */
+
+void trace_binary_streambuf::write_records(){
+    if(!records.empty()){
+        fwrite(records.data(), sizeof(trace_record), records.size(), file);
+        record_count += records.size();
+        records.clear();
+    }
+}
+
+/**
+ * Turns one logger line into records: a time line updates the current
+ * time, a message line gives one record for every message of every non
+ * empty port, the messages after the first one of a bag are flagged
+ * TRACE_SAME_BAG.
+ * @param line
+ */
+
+void trace_binary_streambuf::on_line(std::string_view line){
+    if(file == NULL){
+        return;
+    }
+    if(is_time_line(line)){
+        time = log_time_to_milliseconds(line);
+        return;
+    }
+    std::string_view model;
+    for_each_port_value(line, model,
+        [&](std::string_view port, std::string_view value){
+            trace_record record = {};
+            record.time = time;
+            record.model = intern(model_ids, model_names, model);
+            record.port = intern(port_ids, port_names, port);
+
+            // a bag with several messages is written as "v1, v2"
+            std::string text(value);
+            char *position = &text[0];
+            char *end = position + text.size();
+            while(position < end){
+                char *parsed;
+                if(!parse_trace_value(position, &parsed, record)){
+                    break;
+                }
+                records.push_back(record);
+                record.flags |= TRACE_SAME_BAG;
+                position = parsed;
+                while(position < end && (*position == ',' || *position == ' ')){
+                    position++;
+                }
+            }
+            if(records.size() >= TRACE_BUFFER_RECORDS){
+                write_records();
+            }
+        });
+}
+
+/**
+ * Closes the trace.
+ */
+
+trace_reader::~trace_reader(){
+    if(file != NULL){
+        fclose(file);
+    }
+}
+
+/**
+ * Reads the header and the dictionary, then goes back to the first record.
+ * @param path
+ * @return false if the file cannot be opened or is not a trace
+ */
+
+bool trace_reader::open(const char *path){
+    file = fopen(path, "rb");
+    if(file == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    if(fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(trace_record)){
+        printf("ERROR %s is not a binary trace", path);
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+
+    fseek(file, static_cast<long>(header.dictionary_offset), SEEK_SET);
+    for(std::vector<std::string> *names : {&model_names, &port_names}){
+        uint32_t count = 0;
+        if(fread(&count, sizeof(count), 1, file) != 1){
+            count = 0;
+        }
+        for(uint32_t i = 0; i < count; i++){
+            uint16_t length = 0;
+            if(fread(&length, sizeof(length), 1, file) != 1){
+                break;
+            }
+            std::string name(length, '\0');
+            if(length > 0 && fread(&name[0], 1, length, file) != length){
+                break;
+            }
+            names->push_back(std::move(name));
+        }
+    }
+
+    fseek(file, sizeof(trace_header), SEEK_SET);
+    records_read = 0;
+    buffer.clear();
+    buffer_position = 0;
+    return true;
+}
+
+/**
+ * Gives the next record, reading the file by blocks of records.
+ * @param record
+ * @return false at the end of the trace
+ */
+
+bool trace_reader::next(trace_record &record){
+    if(buffer_position == buffer.size()){
+        if(file == NULL || records_read >= header.record_count){
+            return false;
+        }
+        uint64_t left = header.record_count - records_read;
+        size_t count = left < TRACE_BUFFER_RECORDS ?
+            static_cast<size_t>(left) : TRACE_BUFFER_RECORDS;
+        buffer.resize(count);
+        count = fread(buffer.data(), sizeof(trace_record), count, file);
+        buffer.resize(count);
+        buffer_position = 0;
+        records_read += count;
+        if(count == 0){
+            return false;
+        }
+    }
+    record = buffer[buffer_position++];
+    return true;
+}
+
+/**
+ * Writes a time in milliseconds as "hh:mm:ss:mmm".
+ * @param milliseconds
+ * @param text
+ */
+
+void format_trace_time(int64_t milliseconds, char *text){
+    snprintf(text, 32, "%02lld:%02lld:%02lld:%03lld",
+        static_cast<long long>(milliseconds / 3600000),
+        static_cast<long long>(milliseconds / 60000 % 60),
+        static_cast<long long>(milliseconds / 1000 % 60),
+        static_cast<long long>(milliseconds % 1000));
+}
+
+/**
+ * Reads a number with strtod, then again as an int64_t when it is only
+ * digits, so integers past 2^53 are not rounded.
+ * @param text
+ * @param end
+ * @param record
+ * @return false if there is no number at text
+ */
+
+bool parse_trace_value(const char *text, char **end, trace_record &record){
+    const double value = strtod(text, end);
+    if(*end == text){
+        return false;
+    }
+    const char *first = text;
+    while(*first == ' '){
+        first++;
+    }
+    if(*first == '+'){
+        first++;
+    }
+    int64_t integer;
+    std::from_chars_result parsed = std::from_chars(first, *end, integer);
+    if(parsed.ec == std::errc() && parsed.ptr == *end){
+        record.integer = integer;
+        record.flags |= TRACE_INTEGER;
+    }else{
+        record.value = value;
+        record.flags &= ~TRACE_INTEGER;
+    }
+    return true;
+}
+
+/**
+ * Writes the value of a record as the message logger does.
+ * @param record
+ * @param text
+ */
+
+void format_trace_value(const trace_record &record, char *text){
+    std::to_chars_result written = (record.flags & TRACE_INTEGER) != 0 ?
+        std::to_chars(text, text + 31, record.integer) :
+        std::to_chars(text, text + 31, record.value);
+    *written.ptr = '\0';
+}
+
+/**
+ * This function writes the table of output_filter (time, value, port and
+ * component of every bag) from a binary trace, the messages of a bag are
+ * written in one row as "v1, v2".
+ * @param input
+ * @param output
+ */
+
+void trace_to_output(const char *input, const char *output){
+
+    trace_reader reader;
+    if(!reader.open(input)){
+        return;
+    }
+    FILE *op = fopen(output,"w");
+    if(op == NULL){
+        printf("ERROR in opening file");
+        return;
+    }
+
+    write_output_header(op);
+
+    trace_record record, row = {};
+    bool has_row = false;
+    char time[32], value[32];
+    std::string values, component;
+    // a row is written once the next record does not continue its bag
+    auto write_row = [&](){
+        format_trace_time(row.time, time);
+        // output_filter keeps the space before the component name
+        component = " " + reader.model_name(row.model);
+        write_output_row(op,time,values.c_str(),
+            reader.port_name(row.port).c_str(),component.c_str());
+    };
+    while(reader.next(record)){
+        format_trace_value(record, value);
+        if(has_row && (record.flags & TRACE_SAME_BAG) != 0){
+            values += ", ";
+            values += value;
+            continue;
+        }
+        if(has_row){
+            write_row();
+        }
+        row = record;
+        values = value;
+        has_row = true;
+    }
+    if(has_row){
+        write_row();
+    }
+    fclose(op);
+}
@@ -0,0 +1,691 @@
+/**
+ * \brief This code writes and reads the columnar export of a simulation.
+ *
+ * columnar_writer gathers the messages of one chunk column by column and
+ * encodes every column when the chunk is full, columnar_reader reads back
+ * one column of one chunk at a time. The numbers of a block are packed
+ * with the lowest bit first, a number that does not end on a byte boundary
+ * goes on in the next byte.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "../include/trace_columnar.hpp"
+#include "../include/trace_binary.hpp"
+#include "../include/log_parser.hpp"
+#include "../include/query.hpp"
+#include "../include/filter.hpp"
+
+/**
+ * @param number
+ * @return bits needed to write the number, 0 for 0
+ */
+
+static uint8_t columnar_bit_width(uint64_t number){
+    uint8_t width = 0;
+    while(number != 0){
+        width++;
+        number >>= 1;
+    }
+    return width;
+}
+
+/**
+ * Packs numbers of width bits each.
+ * @param numbers numbers that fit in width bits
+ * @param width bits of every number, 0 to 64
+ * @param bytes receives the packed numbers
+ */
+
+static void pack_bits(const std::vector<uint64_t> &numbers, uint8_t width,
+    std::vector<uint8_t> &bytes){
+
+    const size_t size = (numbers.size() * width + 7) / 8;
+    // room for the last 64 bit write
+    bytes.assign(size + 9, 0);
+    if(width == 0){
+        bytes.clear();
+        return;
+    }
+    uint64_t position = 0;
+    for(uint64_t number : numbers){
+        const size_t byte = position >> 3;
+        const unsigned shift = position & 7;
+        uint64_t word;
+        memcpy(&word, &bytes[byte], sizeof(word));
+        word |= number << shift;
+        memcpy(&bytes[byte], &word, sizeof(word));
+        if(shift + width > 64){
+            bytes[byte + 8] |= static_cast<uint8_t>(number >> (64 - shift));
+        }
+        position += width;
+    }
+    bytes.resize(size);
+}
+
+/**
+ * Unpacks numbers of width bits each.
+ * @param bytes packed numbers followed by at least 9 bytes of padding
+ * @param count number of numbers
+ * @param width bits of every number, 0 to 64
+ * @param numbers receives the numbers
+ */
+
+static void unpack_bits(const uint8_t *bytes, size_t count, uint8_t width,
+    std::vector<uint64_t> &numbers){
+
+    numbers.resize(count);
+    if(width == 0){
+        std::fill(numbers.begin(), numbers.end(), 0);
+        return;
+    }
+    const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+    uint64_t position = 0;
+    for(size_t i = 0; i < count; i++){
+        const size_t byte = position >> 3;
+        const unsigned shift = position & 7;
+        uint64_t word;
+        memcpy(&word, bytes + byte, sizeof(word));
+        uint64_t number = word >> shift;
+        if(shift + width > 64){
+            number |= static_cast<uint64_t>(bytes[byte + 8]) << (64 - shift);
+        }
+        numbers[i] = number & mask;
+        position += width;
+    }
+}
+
+/**
+ * @return the number of a signed difference, small for small differences
+ * of either sign
+ */
+
+static uint64_t zigzag(int64_t difference){
+    return (static_cast<uint64_t>(difference) << 1) ^
+        static_cast<uint64_t>(difference >> 63);
+}
+
+static int64_t unzigzag(uint64_t number){
+    return static_cast<int64_t>(number >> 1) ^ -static_cast<int64_t>(number & 1);
+}
+
+/**
+ * @return true if every value is an integer
+ */
+
+static bool integral_values(const std::vector<trace_record> &values){
+    for(const trace_record &value : values){
+        if((value.flags & TRACE_INTEGER) == 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @return the value of a message as a double, for the statistics
+ */
+
+static double columnar_number(const trace_record &value){
+    return (value.flags & TRACE_INTEGER) != 0 ?
+        static_cast<double>(value.integer) : value.value;
+}
+
+/**
+ * Completes the file if close was not called.
+ */
+
+columnar_writer::~columnar_writer(){
+    close();
+}
+
+/**
+ * Opens the file and reserves the space of the header.
+ * @param path
+ * @return false if the file cannot be opened
+ */
+
+bool columnar_writer::open(const char *path){
+    close();
+    file = fopen(path, "wb");
+    if(file == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    columnar_header header = {};
+    fwrite(&header, sizeof(header), 1, file);
+    offset = sizeof(header);
+    row_count = 0;
+    table_rows = 0;
+    chunks.clear();
+    component_ids.clear();
+    port_ids.clear();
+    component_names.clear();
+    port_names.clear();
+    return true;
+}
+
+void columnar_writer::add(const trace_record &message,
+    std::string_view component, std::string_view port){
+
+    if(file == NULL){
+        return;
+    }
+    // the first message of the file always starts a bag
+    const bool same_bag = (message.flags & TRACE_SAME_BAG) != 0 && table_rows > 0;
+    if(!same_bag){
+        table_rows++;
+    }
+    times.push_back(message.time);
+    components.push_back(intern(component_ids, component_names, component));
+    ports.push_back(intern(port_ids, port_names, port));
+    values.push_back(message);
+    bags.push_back(same_bag ? 1 : 0);
+    if(times.size() >= COLUMNAR_CHUNK_ROWS){
+        write_chunk();
+    }
+}
+
+/**
+ * Writes the last chunk, then the dictionaries and the directory, and
+ * rewrites the header. Dictionary layout: number of components, the
+ * components, number of ports, the ports; every name is its length
+ * (uint16_t) followed by its characters. The directory is one
+ * columnar_chunk per chunk.
+ */
+
+void columnar_writer::close(){
+    if(file == NULL){
+        return;
+    }
+    write_chunk();
+
+    columnar_header header = {};
+    memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+    header.version = COLUMNAR_VERSION;
+    header.chunk_rows = COLUMNAR_CHUNK_ROWS;
+    header.row_count = row_count;
+    header.chunk_count = chunks.size();
+    header.dictionary_offset = offset;
+
+    for(const std::vector<std::string> *names : {&component_names, &port_names}){
+        uint32_t count = static_cast<uint32_t>(names->size());
+        fwrite(&count, sizeof(count), 1, file);
+        for(const std::string &name : *names){
+            uint16_t length = static_cast<uint16_t>(name.size());
+            fwrite(&length, sizeof(length), 1, file);
+            fwrite(name.data(), 1, length, file);
+        }
+    }
+    if(!chunks.empty()){
+        fwrite(chunks.data(), sizeof(columnar_chunk), chunks.size(), file);
+    }
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    fclose(file);
+    file = NULL;
+}
+
+/**
+ * Gives the index of a name, adding it to the dictionary the first time.
+ * @param ids index of every known name
+ * @param names known names in index order
+ * @param name name to look for
+ * @return the index of the name
+ */
+
+uint32_t columnar_writer::intern(std::unordered_map<std::string, uint32_t> &ids,
+    std::vector<std::string> &names, std::string_view name){
+
+    std::string key(name);
+    auto found = ids.find(key);
+    if(found != ids.end()){
+        return found->second;
+    }
+    uint32_t id = static_cast<uint32_t>(names.size());
+    ids.emplace(key, id);
+    names.push_back(std::move(key));
+    return id;
+}
+
+/**
+ * Encodes the columns of the rows gathered and writes them.
+ */
+
+void columnar_writer::write_chunk(){
+    if(times.empty()){
+        return;
+    }
+    const size_t rows = times.size();
+    columnar_chunk chunk = {};
+    chunk.rows = static_cast<uint32_t>(rows);
+    chunk.time_min = *std::min_element(times.begin(), times.end());
+    chunk.time_max = *std::max_element(times.begin(), times.end());
+    chunk.component_min = *std::min_element(components.begin(), components.end());
+    chunk.component_max = *std::max_element(components.begin(), components.end());
+    chunk.port_min = *std::min_element(ports.begin(), ports.end());
+    chunk.port_max = *std::max_element(ports.begin(), ports.end());
+    chunk.value_min = columnar_number(values[0]);
+    chunk.value_max = chunk.value_min;
+    for(const trace_record &value : values){
+        chunk.value_min = std::min(chunk.value_min, columnar_number(value));
+        chunk.value_max = std::max(chunk.value_max, columnar_number(value));
+    }
+    // the last message is in row table_rows - 1, every bag started after
+    // the first message of the chunk is one row before it
+    chunk.first_row = table_rows - 1 -
+        static_cast<uint64_t>(std::count(bags.begin() + 1, bags.end(), 0));
+
+    std::vector<uint64_t> numbers;
+    std::vector<uint8_t> bytes;
+    uint64_t largest;
+
+    // times: the first one, then the differences
+    columnar_block &time = chunk.columns[COLUMNAR_TIME];
+    time.encoding = COLUMNAR_DELTA;
+    time.base = times[0];
+    numbers.resize(rows);
+    largest = 0;
+    numbers[0] = 0;
+    for(size_t i = 1; i < rows; i++){
+        numbers[i] = zigzag(times[i] - times[i - 1]);
+        largest = std::max(largest, numbers[i]);
+    }
+    time.bit_width = columnar_bit_width(largest);
+    pack_bits(numbers, time.bit_width, bytes);
+    write_block(time, bytes);
+
+    // dictionary indexes, from the smallest one of the chunk
+    const std::pair<columnar_column, const std::vector<uint32_t>*> ids[] = {
+        {COLUMNAR_COMPONENT, &components}, {COLUMNAR_PORT, &ports}
+    };
+    for(const auto &column : ids){
+        const std::vector<uint32_t> &id = *column.second;
+        columnar_block &block = chunk.columns[column.first];
+        block.encoding = COLUMNAR_PACKED;
+        block.base = column.first == COLUMNAR_COMPONENT ?
+            chunk.component_min : chunk.port_min;
+        largest = 0;
+        for(size_t i = 0; i < rows; i++){
+            numbers[i] = id[i] - block.base;
+            largest = std::max(largest, numbers[i]);
+        }
+        block.bit_width = columnar_bit_width(largest);
+        pack_bits(numbers, block.bit_width, bytes);
+        write_block(block, bytes);
+    }
+
+    // values: packed integers from the smallest one, or doubles
+    columnar_block &value = chunk.columns[COLUMNAR_VALUE];
+    if(integral_values(values)){
+        value.encoding = COLUMNAR_PACKED;
+        value.base = values[0].integer;
+        for(const trace_record &message : values){
+            value.base = std::min(value.base, message.integer);
+        }
+        largest = 0;
+        for(size_t i = 0; i < rows; i++){
+            // unsigned, so the difference of any two int64_t fits
+            numbers[i] = static_cast<uint64_t>(values[i].integer) -
+                static_cast<uint64_t>(value.base);
+            largest = std::max(largest, numbers[i]);
+        }
+        value.bit_width = columnar_bit_width(largest);
+        pack_bits(numbers, value.bit_width, bytes);
+    }else{
+        value.encoding = COLUMNAR_DOUBLE;
+        value.bit_width = 64;
+        bytes.resize(rows * sizeof(double));
+        for(size_t i = 0; i < rows; i++){
+            const double number = columnar_number(values[i]);
+            memcpy(&bytes[i * sizeof(double)], &number, sizeof(double));
+        }
+    }
+    write_block(value, bytes);
+
+    // bags: one bit per message, no bytes at all when every bag has one
+    columnar_block &bag = chunk.columns[COLUMNAR_BAG];
+    bag.encoding = COLUMNAR_PACKED;
+    largest = 0;
+    for(size_t i = 0; i < rows; i++){
+        numbers[i] = bags[i];
+        largest = std::max(largest, numbers[i]);
+    }
+    bag.bit_width = columnar_bit_width(largest);
+    pack_bits(numbers, bag.bit_width, bytes);
+    write_block(bag, bytes);
+
+    chunks.push_back(chunk);
+    row_count += rows;
+    times.clear();
+    components.clear();
+    ports.clear();
+    values.clear();
+    bags.clear();
+}
+
+/**
+ * Writes the bytes of one block and records where they are.
+ * @param block
+ * @param bytes
+ */
+
+void columnar_writer::write_block(columnar_block &block,
+    const std::vector<uint8_t> &bytes){
+
+    block.offset = offset;
+    block.size = static_cast<uint32_t>(bytes.size());
+    if(!bytes.empty()){
+        fwrite(bytes.data(), 1, bytes.size(), file);
+    }
+    offset += bytes.size();
+}
+
+/**
+ * Closes the file.
+ */
+
+columnar_reader::~columnar_reader(){
+    if(file != NULL){
+        fclose(file);
+    }
+}
+
+/**
+ * Reads the header, the dictionaries and the directory.
+ * @param path
+ * @return false if the file cannot be opened or is not a columnar file
+ */
+
+bool columnar_reader::open(const char *path){
+    file = fopen(path, "rb");
+    if(file == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    if(fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, COLUMNAR_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COLUMNAR_VERSION){
+        printf("ERROR %s is not a columnar file", path);
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+
+    fseek(file, static_cast<long>(header.dictionary_offset), SEEK_SET);
+    for(std::vector<std::string> *names : {&component_names, &port_names}){
+        uint32_t count = 0;
+        if(fread(&count, sizeof(count), 1, file) != 1){
+            count = 0;
+        }
+        for(uint32_t i = 0; i < count; i++){
+            uint16_t length = 0;
+            if(fread(&length, sizeof(length), 1, file) != 1){
+                break;
+            }
+            std::string name(length, '\0');
+            if(length > 0 && fread(&name[0], 1, length, file) != length){
+                break;
+            }
+            names->push_back(std::move(name));
+        }
+    }
+    chunks.resize(header.chunk_count);
+    if(!chunks.empty() && fread(chunks.data(), sizeof(columnar_chunk),
+        chunks.size(), file) != chunks.size()){
+        printf("ERROR %s is not a columnar file", path);
+        chunks.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the block of one column of a chunk and unpacks its numbers.
+ * @param chunk
+ * @param column
+ * @param numbers
+ * @return false if the block cannot be read
+ */
+
+bool columnar_reader::read_numbers(const columnar_chunk &chunk,
+    columnar_column column, std::vector<uint64_t> &numbers){
+
+    const columnar_block &source = chunk.columns[column];
+    block.resize(source.size + 9);
+    if(fseek(file, static_cast<long>(source.offset), SEEK_SET) != 0 ||
+        fread(block.data(), 1, source.size, file) != source.size){
+        return false;
+    }
+    memset(block.data() + source.size, 0, 9);
+    unpack_bits(block.data(), chunk.rows, source.bit_width, numbers);
+    return true;
+}
+
+bool columnar_reader::read_times(size_t index, std::vector<int64_t> &times){
+    const columnar_chunk &chunk = chunks[index];
+    if(!read_numbers(chunk, COLUMNAR_TIME, numbers)){
+        return false;
+    }
+    times.resize(chunk.rows);
+    int64_t time = chunk.columns[COLUMNAR_TIME].base;
+    for(size_t i = 0; i < chunk.rows; i++){
+        time += unzigzag(numbers[i]);
+        times[i] = time;
+    }
+    return true;
+}
+
+bool columnar_reader::read_ids(size_t index, columnar_column column,
+    std::vector<uint32_t> &ids){
+
+    const columnar_chunk &chunk = chunks[index];
+    if(!read_numbers(chunk, column, numbers)){
+        return false;
+    }
+    ids.resize(chunk.rows);
+    const int64_t base = chunk.columns[column].base;
+    for(size_t i = 0; i < chunk.rows; i++){
+        ids[i] = static_cast<uint32_t>(numbers[i] + base);
+    }
+    return true;
+}
+
+bool columnar_reader::read_values(size_t index, std::vector<trace_record> &values){
+    const columnar_chunk &chunk = chunks[index];
+    const columnar_block &source = chunk.columns[COLUMNAR_VALUE];
+    values.assign(chunk.rows, trace_record{});
+    if(source.encoding == COLUMNAR_DOUBLE){
+        block.resize(chunk.rows * sizeof(double));
+        if(fseek(file, static_cast<long>(source.offset), SEEK_SET) != 0 ||
+            fread(block.data(), sizeof(double), chunk.rows, file) != chunk.rows){
+            return false;
+        }
+        for(size_t i = 0; i < chunk.rows; i++){
+            memcpy(&values[i].value, &block[i * sizeof(double)], sizeof(double));
+        }
+        return true;
+    }
+    if(!read_numbers(chunk, COLUMNAR_VALUE, numbers)){
+        return false;
+    }
+    for(size_t i = 0; i < chunk.rows; i++){
+        values[i].integer = static_cast<int64_t>(numbers[i] +
+            static_cast<uint64_t>(source.base));
+        values[i].flags = TRACE_INTEGER;
+    }
+    return true;
+}
+
+bool columnar_reader::read_rows(size_t index, std::vector<uint64_t> &rows){
+    const columnar_chunk &chunk = chunks[index];
+    if(!read_numbers(chunk, COLUMNAR_BAG, numbers)){
+        return false;
+    }
+    rows.resize(chunk.rows);
+    uint64_t row = chunk.first_row;
+    for(size_t i = 0; i < chunk.rows; i++){
+        if(i > 0 && numbers[i] == 0){
+            row++;
+        }
+        rows[i] = row;
+    }
+    return true;
+}
+
+/**
+ * This function writes the columnar file of an output table. The values
+ * of a bag with several messages ("v1, v2") give one message each, the
+ * ones after the first flagged TRACE_SAME_BAG.
+ * @param input
+ * @param output
+ * @return false if a file cannot be opened
+ */
+
+bool output_to_columnar(const char *input, const char *output){
+
+    FILE *fp = fopen(input,"r");
+    if(fp == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    columnar_writer writer;
+    if(!writer.open(output)){
+        fclose(fp);
+        return false;
+    }
+
+    char *data = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    std::string value;
+    while((length = getline(&data, &capacity, fp)) != -1){
+        query_row row;
+        if(!split_query_row(std::string_view(data, length), row)){
+            continue;
+        }
+        trace_record message = {};
+        message.time = log_time_to_milliseconds(row.time);
+        value.assign(row.value);
+        char *position = &value[0];
+        char *end = position + value.size();
+        while(position < end){
+            char *parsed;
+            if(!parse_trace_value(position, &parsed, message)){
+                break;
+            }
+            writer.add(message, row.component, row.port);
+            message.flags |= TRACE_SAME_BAG;
+            position = parsed;
+            while(position < end && (*position == ',' || *position == ' ')){
+                position++;
+            }
+        }
+    }
+    free(data);
+    fclose(fp);
+    writer.close();
+    return true;
+}
+
+/**
+ * This function writes the columnar file of a binary trace.
+ * @param input
+ * @param output
+ * @return false if a file cannot be opened
+ */
+
+bool trace_to_columnar(const char *input, const char *output){
+
+    trace_reader reader;
+    if(!reader.open(input)){
+        return false;
+    }
+    columnar_writer writer;
+    if(!writer.open(output)){
+        return false;
+    }
+    trace_record record;
+    while(reader.next(record)){
+        writer.add(record, reader.model_name(record.model),
+            reader.port_name(record.port));
+    }
+    writer.close();
+    return true;
+}
+
+/**
+ * This function writes the table of output_filter (time, value, port and
+ * component of every bag) from a columnar file, the messages of one row
+ * are written back as "v1, v2".
+ * @param input
+ * @param output
+ * @return false if a file cannot be opened
+ */
+
+bool columnar_to_output(const char *input, const char *output){
+
+    columnar_reader reader;
+    if(!reader.open(input)){
+        return false;
+    }
+    FILE *op = fopen(output,"w");
+    if(op == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+
+    write_output_header(op);
+
+    std::vector<int64_t> times;
+    std::vector<uint32_t> components, ports;
+    std::vector<trace_record> values;
+    std::vector<uint64_t> rows;
+    char value[32];
+    // row being gathered, written once a message of another row is read
+    char time[32];
+    std::string row_values, component, port;
+    uint64_t row = 0;
+    bool has_row = false;
+    auto write_row = [&](){
+        write_output_row(op,time,row_values.c_str(),port.c_str(),component.c_str());
+    };
+    for(size_t c = 0; c < reader.chunk_count(); c++){
+        if(!reader.read_times(c, times) ||
+            !reader.read_ids(c, COLUMNAR_COMPONENT, components) ||
+            !reader.read_ids(c, COLUMNAR_PORT, ports) ||
+            !reader.read_values(c, values) ||
+            !reader.read_rows(c, rows)){
+            printf("ERROR in reading file");
+            break;
+        }
+        for(size_t i = 0; i < times.size(); i++){
+            format_trace_value(values[i], value);
+            if(has_row && rows[i] == row){
+                row_values += ", ";
+                row_values += value;
+                continue;
+            }
+            if(has_row){
+                write_row();
+            }
+            format_trace_time(times[i], time);
+            row_values = value;
+            port = reader.port_name(ports[i]);
+            // output_filter keeps the space before the component name
+            component = " " + reader.component_name(components[i]);
+            row = rows[i];
+            has_row = true;
+        }
+    }
+    if(has_row){
+        write_row();
+    }
+    fclose(op);
+    return true;
+}
@@ -0,0 +1,31 @@
+/**
+ * \brief This program converts a binary trace to the output.txt table.
+ *
+ * The binary trace is written by main_pg when it runs with --trace=binary.
+ * The table written by this program is the same one output_filter writes
+ * from the text log, so limit_output can be used on it as before.
+ *
+ * Usage: ./trace_to_text path_to_binary_trace path_to_output_table
+ */
+
+#include <iostream>
+
+#include "../text_filter.cpp"
+#include "../trace_binary.cpp"
+
+using namespace std;
+
+int main(int argc, char ** argv){
+
+    if (argc < 3) {
+        cout << "you are using this program with wrong parameters.";
+        cout << "The program should be invoked as follow:";
+        cout << argv[0] << " path to the binary trace, path to the output file"
+             << endl;
+        return 1;
+    }
+
+    trace_to_output(argv[1], argv[2]);
+
+    return 0;
+}
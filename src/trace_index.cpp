@@ -0,0 +1,283 @@
+/**
+ * \brief This code builds and reads the side index of the output table.
+ *
+ * The side index of a raw log is built the same way from its time lines
+ * and bags; its blocks start on a time line so that run_queries knows the
+ * time of the first bag of every block it reads.
+ *
+ * Index file layout (all integers little endian as written by the host):
+ *   magic "ABPINDEX", version (uint32_t),
+ *   size and modification time of the table (uint64_t, int64_t),
+ *   number of blocks (uint32_t), then every index_block,
+ *   number of keys (uint32_t), then for every key: component and port
+ *   (uint16_t length and characters each), number of blocks (uint32_t) and
+ *   the block numbers (uint32_t).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <map>
+#include <string_view>
+#include <utility>
+
+#include "../include/trace_index.hpp"
+#include "../include/log_parser.hpp"
+
+static constexpr char INDEX_MAGIC[8] = {'A','B','P','I','N','D','E','X'};
+static constexpr uint32_t INDEX_VERSION = 1;
+
+/**
+ * Reads the size and modification time of the table.
+ * @param table
+ * @param size
+ * @param mtime modification time in nanoseconds
+ * @return false if the table does not exist
+ */
+
+static bool table_signature(const char *table, uint64_t &size, int64_t &mtime){
+    struct stat information;
+    if(stat(table, &information) != 0){
+        return false;
+    }
+    size = static_cast<uint64_t>(information.st_size);
+    mtime = static_cast<int64_t>(information.st_mtim.tv_sec) * 1000000000LL +
+        information.st_mtim.tv_nsec;
+    return true;
+}
+
+std::string table_index_path(const char *table){
+    return std::string(table) + ".idx";
+}
+
+static void write_index_string(FILE *op, const std::string &text){
+    uint16_t length = static_cast<uint16_t>(text.size());
+    fwrite(&length, sizeof(length), 1, op);
+    fwrite(text.data(), 1, length, op);
+}
+
+static bool read_index_string(FILE *fp, std::string &text){
+    uint16_t length;
+    if(fread(&length, sizeof(length), 1, fp) != 1){
+        return false;
+    }
+    text.assign(length, '\0');
+    return length == 0 || fread(&text[0], 1, length, fp) == length;
+}
+
+/**
+ * Reads the table row by row, closes a block every INDEX_BLOCK_BYTES and
+ * records in which blocks every component/port pair appears. A raw log is
+ * read line by line and its blocks are only closed before a time line.
+ * @param table
+ * @return false if a file cannot be opened
+ */
+
+bool build_table_index(const char *table){
+
+    table_index index;
+    if(!table_signature(table, index.source_size, index.source_mtime)){
+        printf("ERROR in opening file");
+        return false;
+    }
+    FILE *fp = fopen(table,"r");
+    if(fp == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+
+    std::map<std::pair<std::string, std::string>, uint32_t> keys;
+    index_block block = {0, 0, 0, 0};
+    bool block_has_rows = false;
+    uint64_t offset = 0;
+
+    // starts a new block at offset once the current one is full
+    auto add_time = [&](double time){
+        if(block_has_rows && block.length >= INDEX_BLOCK_BYTES){
+            index.blocks.push_back(block);
+            block_has_rows = false;
+        }
+        if(!block_has_rows){
+            block = {offset, 0, time, time};
+            block_has_rows = true;
+        }
+        block.time_min = std::min(block.time_min, time);
+        block.time_max = std::max(block.time_max, time);
+    };
+
+    auto add_key = [&](std::string_view component, std::string_view port){
+        auto key = std::make_pair(std::string(component), std::string(port));
+        auto found = keys.find(key);
+        if(found == keys.end()){
+            found = keys.emplace(key,
+                static_cast<uint32_t>(index.postings.size())).first;
+            index.components.push_back(key.first);
+            index.ports.push_back(key.second);
+            index.postings.emplace_back();
+        }
+        std::vector<uint32_t> &posting = index.postings[found->second];
+        const uint32_t block_number = static_cast<uint32_t>(index.blocks.size());
+        if(posting.empty() || posting.back() != block_number){
+            posting.push_back(block_number);
+        }
+    };
+
+    const bool raw_log = is_raw_log(fp);
+    char *data = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while((length = getline(&data, &capacity, fp)) != -1){
+        std::string_view line(data, length);
+        if(raw_log){
+            if(is_time_line(trim_right(line))){
+                add_time(log_time_to_seconds(trim_right(line)));
+            }else if(block_has_rows){
+                std::string_view model;
+                for_each_port_value(line, model,
+                    [&](std::string_view port, std::string_view){
+                        add_key(model, port);
+                    });
+            }
+            if(block_has_rows){
+                block.length = offset + length - block.offset;
+            }
+        }else{
+            query_row row;
+            if(split_query_row(line, row)){
+                add_time(log_time_to_seconds(row.time));
+                add_key(row.component, row.port);
+                block.length = offset + length - block.offset;
+            }
+        }
+        offset += length;
+    }
+    if(block_has_rows){
+        index.blocks.push_back(block);
+    }
+    free(data);
+    fclose(fp);
+
+    FILE *op = fopen(table_index_path(table).c_str(),"wb");
+    if(op == NULL){
+        printf("ERROR in opening file");
+        return false;
+    }
+    fwrite(INDEX_MAGIC, 1, sizeof(INDEX_MAGIC), op);
+    fwrite(&INDEX_VERSION, sizeof(INDEX_VERSION), 1, op);
+    fwrite(&index.source_size, sizeof(index.source_size), 1, op);
+    fwrite(&index.source_mtime, sizeof(index.source_mtime), 1, op);
+    uint32_t count = static_cast<uint32_t>(index.blocks.size());
+    fwrite(&count, sizeof(count), 1, op);
+    fwrite(index.blocks.data(), sizeof(index_block), count, op);
+    count = static_cast<uint32_t>(index.postings.size());
+    fwrite(&count, sizeof(count), 1, op);
+    for(uint32_t key = 0; key < count; key++){
+        write_index_string(op, index.components[key]);
+        write_index_string(op, index.ports[key]);
+        uint32_t blocks = static_cast<uint32_t>(index.postings[key].size());
+        fwrite(&blocks, sizeof(blocks), 1, op);
+        fwrite(index.postings[key].data(), sizeof(uint32_t), blocks, op);
+    }
+    fclose(op);
+    return true;
+}
+
+/**
+ * Loads the index and checks that the table did not change since.
+ * @param table
+ * @param index
+ * @return false if there is no usable index
+ */
+
+bool load_table_index(const char *table, table_index &index){
+
+    uint64_t size;
+    int64_t mtime;
+    if(!table_signature(table, size, mtime)){
+        return false;
+    }
+    FILE *fp = fopen(table_index_path(table).c_str(),"rb");
+    if(fp == NULL){
+        return false;
+    }
+
+    char magic[8];
+    uint32_t version;
+    bool ok = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) &&
+        memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0 &&
+        fread(&version, sizeof(version), 1, fp) == 1 &&
+        version == INDEX_VERSION &&
+        fread(&index.source_size, sizeof(index.source_size), 1, fp) == 1 &&
+        fread(&index.source_mtime, sizeof(index.source_mtime), 1, fp) == 1 &&
+        index.source_size == size && index.source_mtime == mtime;
+
+    uint32_t count = 0;
+    if(ok && fread(&count, sizeof(count), 1, fp) == 1){
+        index.blocks.resize(count);
+        ok = fread(index.blocks.data(), sizeof(index_block), count, fp) == count;
+    }else{
+        ok = false;
+    }
+    if(ok && fread(&count, sizeof(count), 1, fp) == 1){
+        index.components.resize(count);
+        index.ports.resize(count);
+        index.postings.resize(count);
+        for(uint32_t key = 0; ok && key < count; key++){
+            uint32_t blocks = 0;
+            ok = read_index_string(fp, index.components[key]) &&
+                read_index_string(fp, index.ports[key]) &&
+                fread(&blocks, sizeof(blocks), 1, fp) == 1;
+            if(ok){
+                index.postings[key].resize(blocks);
+                ok = fread(index.postings[key].data(), sizeof(uint32_t),
+                    blocks, fp) == blocks;
+            }
+        }
+    }else{
+        ok = false;
+    }
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * Gives the blocks that can hold matching rows: the blocks of every key
+ * accepted by a predicate, whose time span overlaps the predicate range.
+ * @param index
+ * @param groups
+ * @return block numbers in table order
+ */
+
+std::vector<uint32_t> select_index_blocks(const table_index &index,
+    const std::vector<query_group> &groups){
+
+    std::vector<bool> selected(index.blocks.size(), false);
+    for(const query_group &group : groups){
+        for(const query_predicate &predicate : group.predicates){
+            for(size_t key = 0; key < index.postings.size(); key++){
+                if((!predicate.component.empty() &&
+                    predicate.component != index.components[key]) ||
+                    (!predicate.port.empty() && predicate.port != index.ports[key])){
+                    continue;
+                }
+                for(uint32_t block : index.postings[key]){
+                    if(index.blocks[block].time_max >= predicate.time_min &&
+                        index.blocks[block].time_min <= predicate.time_max){
+                        selected[block] = true;
+                    }
+                }
+            }
+        }
+    }
+    std::vector<uint32_t> blocks;
+    for(size_t block = 0; block < selected.size(); block++){
+        if(selected[block]){
+            blocks.push_back(static_cast<uint32_t>(block));
+        }
+    }
+    return blocks;
+}
@@ -53,11 +53,14 @@
 #include <cadmium/logger/common_loggers.hpp>
 
 #include "../../../include/message.hpp"
+#include "../../../include/packet.hpp"
 #include "../../../lib/DESTimes/include/NDTime.hpp"
 #include "../../../lib/vendor/include/iestream.hpp"
 #include "../../../include/receiver_cadmium.hpp"
 
 #include "../../../src/text_filter.cpp"
+#include "../../../src/query.cpp"
+#include "../../../src/trace_index.cpp"
 #include "../../../src/limit_output.cpp"
 
 #include "../../../include/filter.hpp"
@@ -71,13 +74,13 @@ using TIME = NDTime;
  *  Sets input ports for message
  */
 
-struct input : public cadmium::in_port<message_t>{};
+struct input : public cadmium::in_port<packet_t>{};
 
 /**
  *  Sets Output ports for message
  */
 
-struct output : public cadmium::out_port<message_t>{};
+struct output : public cadmium::out_port<packet_t>{};
 
 /**
  * \brief class ApplicationGen for Application Generator.
@@ -87,7 +90,7 @@ struct output : public cadmium::out_port<message_t>{};
  */
 
 template<typename T>
-class ApplicationGen : public iestream_input<message_t,T>{
+class ApplicationGen : public iestream_input<packet_t,T>{
     public:
 
     /**
@@ -101,7 +104,7 @@ class ApplicationGen : public iestream_input<message_t,T>{
      * file path for the Application generator
      */
 
-    ApplicationGen(const char* file_path) : iestream_input<message_t,
+    ApplicationGen(const char* file_path) : iestream_input<packet_t,
         T>(file_path) {}
 };
 
@@ -217,7 +220,7 @@ int main(){
     };
 
     cadmium::dynamic::modeling::ICs ics_TOP = {
-        cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
+        cadmium::dynamic::translate::make_IC<iestream_input_defs<packet_t>::out,
         receiver_defs::input>("generator","receiver1")
     };
     std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
@@ -63,6 +63,7 @@
 #include <cadmium/logger/tuple_to_ostream.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 #include "../../../include/message.hpp"
+#include "../../../include/packet.hpp"
 
 
 #include "../../../lib/DESTimes/include/NDTime.hpp"
@@ -71,6 +72,8 @@
 #include "../../../include/sender_cadmium.hpp"
 
 #include "../../../src/text_filter.cpp"
+#include "../../../src/query.cpp"
+#include "../../../src/trace_index.cpp"
 #include "../../../src/limit_output.cpp"
 
 #include "../../../include/filter.hpp"
@@ -92,7 +95,7 @@ struct input_control : public cadmium::in_port<message_t>{};
  * Setting input port for receiving acknowledgment
  */
 
-struct input_acknowledge : public cadmium::in_port<message_t>{};
+struct input_acknowledge : public cadmium::in_port<packet_t>{};
 
 /**
  *  Setting Output ports for acknowledgment
@@ -104,7 +107,7 @@ struct output_ack : public cadmium::out_port<message_t>{};
  *  Setting Output ports for data
  */
 
-struct output_data : public cadmium::out_port<message_t>{};
+struct output_data : public cadmium::out_port<packet_t>{};
 
 /**
  *  Setting Output ports for the data packets
@@ -138,6 +141,32 @@ class ApplicationGen : public iestream_input<message_t,T> {
         T>(file_path) {}
 };
 
+/**
+ * \brief class AcknowledgeGen for the acknowledgment generator.
+ *
+ *  The below class acknowledgment generator(AcknowledgeGen) takes the file
+ *  path and transmits the acknowledgments as packets.
+ */
+
+template<typename T>
+class AcknowledgeGen : public iestream_input<packet_t,T> {
+    public:
+
+    /**
+     * Default constructor for the class
+     */
+
+    AcknowledgeGen() = default;
+
+    /**
+     * The below parameterized constructor of AcknowledgeGen class takes
+     * the input file path for the acknowledgment generator
+     */
+
+    AcknowledgeGen(const char* file_path) : iestream_input<packet_t,
+        T>(file_path) {}
+};
+
 
 int main(){
 
@@ -241,7 +270,7 @@ int main(){
      */
 
     std::shared_ptr<cadmium::dynamic::modeling::model> generator_ack =
-        cadmium::dynamic::translate::make_dynamic_atomic_model<ApplicationGen,
+        cadmium::dynamic::translate::make_dynamic_atomic_model<AcknowledgeGen,
         TIME, const char* >("generator_ack" ,std::move(p_input_data_ack));
 
     /**
@@ -276,7 +305,7 @@ int main(){
     cadmium::dynamic::modeling::ICs ics_TOP = {
         cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
         sender_defs::control_in>("generator_con","sender1"),
-        cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
+        cadmium::dynamic::translate::make_IC<iestream_input_defs<packet_t>::out,
         sender_defs::ack_in>("generator_ack","sender1")
     };
     std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
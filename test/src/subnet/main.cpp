@@ -52,6 +52,7 @@
 #include <cadmium/logger/tuple_to_ostream.hpp>
 #include <cadmium/logger/common_loggers.hpp>
 #include "../../../include/message.hpp"
+#include "../../../include/packet.hpp"
 
 
 #include "../../../lib/DESTimes/include/NDTime.hpp"
@@ -60,6 +61,8 @@
 #include "../../../include/subnet_cadmium.hpp"
 
 #include "../../../src/text_filter.cpp"
+#include "../../../src/query.cpp"
+#include "../../../src/trace_index.cpp"
 #include "../../../src/limit_output.cpp"
 
 #include "../../../include/filter.hpp"
@@ -74,13 +77,13 @@ using TIME = NDTime;
  *  Sets input ports for message
  */
 
-struct input_in : public cadmium::in_port<message_t>{};
+struct input_in : public cadmium::in_port<packet_t>{};
 
 /**
  *  Sets Output ports for message
  */
 
-struct output_out: public cadmium::out_port<message_t>{};
+struct output_out: public cadmium::out_port<packet_t>{};
 
 /**
  * \brief class ApplicationGen for Application Generator
@@ -90,7 +93,7 @@ struct output_out: public cadmium::out_port<message_t>{};
  */
 
 template<typename T>
-class ApplicationGen : public iestream_input<message_t,T> {
+class ApplicationGen : public iestream_input<packet_t,T> {
     public:
 
     /**
@@ -104,7 +107,7 @@ class ApplicationGen : public iestream_input<message_t,T> {
      * takes the input file path for the Application generator
      */
 
-    ApplicationGen(const char* file_path) : iestream_input<message_t,
+    ApplicationGen(const char* file_path) : iestream_input<packet_t,
         T>(file_path) {}
 };
 
@@ -220,7 +223,7 @@ int main(){
         output_out>("subnet1")
     };
     cadmium::dynamic::modeling::ICs ics_TOP = {
-        cadmium::dynamic::translate::make_IC<iestream_input_defs<message_t>::out,
+        cadmium::dynamic::translate::make_IC<iestream_input_defs<packet_t>::out,
         subnet_defs::input>("generator","subnet1")
     };
     std::shared_ptr<cadmium::dynamic::modeling::coupled<TIME>> TOP =
@@ -280,6 +283,27 @@ int main(){
      */
     limit_output(p_output_file,p_limit_file,1,c1);
 
+    /**
+     * The channel models of the subnet reject invalid descriptions
+     */
+    for (const char *spec : {"uniform:5:1", "exponential:0", "normal:3:0"}) {
+        try {
+            make_delay_model(spec);
+            cout << "invalid delay model accepted: " << spec << endl;
+            return 1;
+        } catch (const std::invalid_argument &e) {
+            cout << e.what() << endl;
+        }
+    }
+    for (const char *spec : {"bernoulli:1.5", "gilbert:-1:2:0:0.5"}) {
+        try {
+            make_loss_model(spec);
+            cout << "invalid loss model accepted: " << spec << endl;
+            return 1;
+        } catch (const std::invalid_argument &e) {
+            cout << e.what() << endl;
+        }
+    }
 
     return 0;
 }